@@ -0,0 +1,116 @@
+#ifndef ADMISSION_H
+#define ADMISSION_H
+
+#include "metrics.h"
+#include "overhead.h"
+#include "sha256.h"
+#include "task.h"
+
+/**
+ * Periodic resource of a tenant: 'budget_ms' of CPU time every 'period_ms'.
+ */
+typedef struct {
+    char name[TASK_NAME_LEN]; // Empty for a free entry
+    long budget_ms;
+    long period_ms;
+    int max_instances;
+    uint8_t token_hash[SHA256_DIGEST_LEN]; // Of the token issued by RESERVE; the token itself is not kept
+} Reservation;
+
+typedef struct {
+    const TaskType *type;
+    int instance_id;
+    long offset_ms;
+    long period_ms; // Assigned period, above type->period_ms while compressed
+    const Reservation *reservation; // Tenant reservation the instance runs in, NULL for the shared pool
+    int priority;   // SCHED_FIFO priority, from admission_priorities()
+    long long wcet_us; // C_LO fixed when admitted, enforced by the overrun timer; 0 for admission_wcet_us()
+} Task;
+
+typedef enum {
+    ADMISSION_DECLARED = 0, // Static wcet_ms from the catalog
+    ADMISSION_MEASURED      // Profiled bound times wcet_margin, declared until enough samples
+} AdmissionMode;
+
+typedef struct {
+    AdmissionMode mode;
+    double wcet_margin;
+    long server_budget_ms; // Aperiodic server reservation, 0 if disabled
+    long server_period_ms;
+    bool cyclic;           // The set must also fit a cyclic executive table
+    OverheadModel overhead;   // Calibrated host costs, all zero to ignore
+    bool control_on_task_cpu; // Network and supervisor threads can preempt the tasks
+    int command_budget;       // Commands per CONTROL_INTERVAL_MS served by the network thread
+    int event_budget;         // Events per CONTROL_INTERVAL_MS handled by the supervisor
+    Reservation reservations[MAX_RESERVATIONS]; // Admitted at the top level in place of their instances
+} AdmissionPolicy;
+
+/**
+ * WCET used by admission for 'type', in microseconds.
+ */
+long long admission_wcet_us(const AdmissionPolicy *policy, const TaskType *type);
+
+/**
+ * C_LO of an admitted instance: the value it was admitted with, which the
+ * measured bound may since have outgrown, else admission_wcet_us().
+ */
+long long admission_task_wcet_us(const AdmissionPolicy *policy, const Task *task);
+
+/**
+ * Admission test of an active set plus an optional candidate.
+ * Nominal periods are tried first; on overload the elastic tasks are compressed.
+ * Every job is charged the per-job overhead, and when the control plane shares
+ * the task core its threads are tested as rate-limited sporadic tasks.
+ * Instances in a reservation are not looked at: the reservations stand for
+ * them, as deferrable servers of their budget.
+ * In cyclic mode a schedule table must exist instead of passing the RTA.
+ * Shared by the supervisor and the simulator.
+ * @param candidate The task to add, with its type, offset and C_LO, or NULL to test the active set alone.
+ * @param periods_ms On success, the period assigned to every entry (active set order, candidate last).
+ * @param reason On failure, the rejection counter to increment.
+ * @return 1 if schedulable, 0 otherwise.
+ */
+int admission_check(const AdmissionPolicy *policy, const Task *active, int active_count,
+                    const Task *candidate, long *periods_ms, MetricCounter *reason);
+
+/**
+ * Deadline-monotonic SCHED_FIFO priorities, one distinct level per top-level
+ * entry from TASK_PRIORITY_MAX down, in the order the admission test assumes:
+ * equal deadlines rank the aperiodic server first, then the reservations,
+ * then the instances in 'set' order. Instances in a reservation share its
+ * level and must point into policy->reservations; the runtime's budget gate
+ * serves them in release order within it. The ranks change with the
+ * set, so they have to be re-applied after every change to it.
+ * @param priorities Output, one per entry of 'set'.
+ * @return The aperiodic server priority, 0 if there is no server.
+ */
+int admission_priorities(const AdmissionPolicy *policy, const Task *set, int count, int *priorities);
+
+/**
+ * Admission test of a tenant: 'candidate' joins the instances of 'res' in
+ * 'active' and the whole must fit the reservation's supply bound function.
+ * Nothing outside the reservation is looked at, since the top-level test
+ * already guarantees it its budget every period. Periods are never compressed.
+ * @param candidate The task to add, or NULL to test the members alone.
+ * @param reason On failure, the rejection counter to increment.
+ * @return 1 if schedulable, 0 otherwise.
+ */
+int admission_check_reservation(const AdmissionPolicy *policy, const Reservation *res, const Task *active,
+                                int active_count, const Task *candidate, MetricCounter *reason);
+
+/**
+ * Looks a reservation up by name.
+ * @return The reservation, or NULL if there is none.
+ */
+const Reservation *admission_find_reservation(const AdmissionPolicy *policy, const char *name);
+
+struct CyclicTable;
+
+/**
+ * Builds the cyclic executive table for 'set' (assigned periods), leaving room
+ * for the per-frame wake-up and for the control threads sharing the task core.
+ * @return The table (free with cyclic_free), or NULL if the set does not fit.
+ */
+struct CyclicTable *admission_cyclic_table(const AdmissionPolicy *policy, const Task *set, int count);
+
+#endif
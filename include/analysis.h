@@ -0,0 +1,118 @@
+#ifndef ANALYSIS_H
+#define ANALYSIS_H
+
+#include "task.h"
+
+/**
+ * Timing parameters of one entry of a candidate task set, in microseconds.
+ * Entries are scheduled by fixed priorities in deadline-monotonic order,
+ * after the entries with an explicit priority.
+ */
+typedef struct {
+    const char *name;
+    long long wcet_us;       // LO-mode budget
+    long long wcet_hi_us;    // HI-mode budget, equal to wcet_us unless the entry is a HI task
+    Criticality criticality; // CRIT_LO entries stop at the switch to HI mode
+    long long period_us;
+    long long deadline_us;
+    long long offset_us;
+    long long period_max_us; // Elastic upper bound, equal to period_us if rigid
+    double elasticity;
+    long long jitter_us;     // Release jitter, T - C for a deferrable server
+    int priority;            // Explicit SCHED_FIFO priority above every task (control threads), 0 for DM
+    int ref;                 // Caller's index, preserved across sorting, -1 if not a task
+    int tiebreak;            // Rank among DM entries of equal deadline, lowest first
+} AnalysisTask;
+
+/**
+ * Details of the first entry found unschedulable by a test.
+ */
+typedef struct {
+    const char *name;
+    long long response_us;
+    long long deadline_us;
+} AnalysisMiss;
+
+/**
+ * Sorts the entries in place by priority: explicit priorities first, then
+ * shortest deadline first, then lowest tiebreak. The order is total, so it
+ * is the order of the distinct priorities the runtime assigns.
+ */
+void analysis_sort(AnalysisTask *tasks, int count);
+
+/**
+ * Computes the total utilization sum(C/T) of the set.
+ */
+double analysis_utilization(const AnalysisTask *tasks, int count);
+
+/**
+ * Response Time Analysis assuming a synchronous (critical instant) release.
+ * Sufficient for any release offsets. Sorts the set in place.
+ * @param miss Optional output describing the failing entry.
+ * @return 1 if schedulable, 0 otherwise.
+ */
+int analysis_rta(AnalysisTask *tasks, int count, AnalysisMiss *miss);
+
+/**
+ * HI-mode test of Adaptive Mixed Criticality (AMC-rtb): every CRIT_HI entry
+ * must meet its deadline with wcet_hi_us. Higher-priority HI entries interfere
+ * with their HI budgets; higher-priority LO entries only until the entry's
+ * LO-mode response time, by which the switch has happened. The LO mode is the
+ * plain test with wcet_us. Sorts the set in place.
+ * @param miss Optional output describing the failing entry.
+ * @return 1 if schedulable, 0 otherwise.
+ */
+int analysis_amc_hi(AnalysisTask *tasks, int count, AnalysisMiss *miss);
+
+/**
+ * Level-i busy time: how long 'work_us' of demand takes to complete when every
+ * entry of 'hp' has higher priority and is released at the same instant
+ * (their jitter included).
+ * @return The busy time in microseconds, or -1 if it exceeds 'limit_us'.
+ */
+long long analysis_busy_time(const AnalysisTask *hp, int count, long long work_us, long long limit_us);
+
+/**
+ * Supply bound function of a periodic resource (Shin & Lee): the least CPU
+ * time a reservation of 'budget_us' every 'period_us' provides in any
+ * interval of 't_us'. The worst case starts with a blackout of 2 * (period - budget).
+ */
+long long analysis_sbf(long long budget_us, long long period_us, long long t_us);
+
+/**
+ * Test of a set running inside a reservation, whose jobs are served in
+ * release order (FIFO), as the runtime's budget gate enforces. Every release of the reservation's busy period, with
+ * all entries released together and ties resolved against the job under
+ * test, must complete by its deadline on the supply bound function.
+ * Offsets, jitter and priorities are ignored.
+ * @param miss Optional output describing the failing entry.
+ * @return 1 if schedulable, 0 otherwise.
+ */
+int analysis_reservation(const AnalysisTask *tasks, int count, long long budget_us, long long period_us,
+                         AnalysisMiss *miss);
+
+/**
+ * Exact test for periodic tasks with release offsets: simulates the
+ * fixed-priority schedule over [0, O_max + 2H) (Leung & Whitehead).
+ * Assumes distinct priorities in sorted order: of two entries with equal
+ * deadlines, the one with the lower tiebreak preempts the other, as the
+ * runtime ranks them (admission_priorities()).
+ * Jittered entries are tested by their busy time instead, and charged to every
+ * lower priority job as the interference they can cause within its deadline.
+ * Sorts the set in place.
+ * @param miss Optional output describing the failing entry.
+ * @return 1 if schedulable, 0 if a deadline is missed,
+ *         -1 if the hyperperiod exceeds MAX_HYPERPERIOD_MS.
+ */
+int analysis_offset_simulation(AnalysisTask *tasks, int count, AnalysisMiss *miss);
+
+/**
+ * Elastic compression (Buttazzo): stretches the periods of elastic entries
+ * within [period_us, period_max_us], in proportion to their elasticity, until
+ * the set passes analysis_rta() and analysis_amc_hi(). Tries the largest utilization first.
+ * Entries keep their order; period_us is updated on success only.
+ * @return 1 if a schedulable assignment was found, 0 otherwise.
+ */
+int analysis_elastic(AnalysisTask *tasks, int count);
+
+#endif
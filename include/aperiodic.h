@@ -0,0 +1,58 @@
+#ifndef APERIODIC_H
+#define APERIODIC_H
+
+#include <stdbool.h>
+#include "task.h"
+
+/**
+ * Counters of the aperiodic server, for INFO.
+ */
+typedef struct {
+    long budget_ms;
+    long period_ms;
+    unsigned long long submitted;
+    unsigned long long completed;
+    int queued;
+    double max_response_ms;
+    double avg_response_ms;
+} AperiodicStats;
+
+/**
+ * Starts the deferrable server thread that runs SUBMIT jobs in FIFO order.
+ * The budget is refilled to 'budget_ms' every 'period_ms'; unused budget is
+ * kept until the end of the period. A job starts only if the remaining budget
+ * covers its declared WCET, C_HI for a HI task.
+ * @param cpu The task core.
+ * @param priority SCHED_FIFO priority, from admission_priorities().
+ * @return 0 on success, -1 on failure.
+ */
+int aperiodic_start(long budget_ms, long period_ms, int cpu, int priority);
+
+/**
+ * Moves the server thread to another priority, when the ranks change with the
+ * task set. A no-op if the server was not started.
+ */
+void aperiodic_set_priority(int priority);
+
+/**
+ * @return true if the server was started.
+ */
+bool aperiodic_enabled(void);
+
+/**
+ * Queues one job of 'type'.
+ * @return The job number, or -1 if the queue is full.
+ */
+long aperiodic_submit(const TaskType *type);
+
+/**
+ * Snapshot of the server counters.
+ */
+void aperiodic_get_stats(AperiodicStats *out);
+
+/**
+ * Stops the server thread. Queued jobs are discarded.
+ */
+void aperiodic_stop(void);
+
+#endif
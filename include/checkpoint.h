@@ -0,0 +1,75 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "constants.h"
+#include "sha256.h"
+
+/**
+ * One admitted instance as saved in the state file.
+ */
+typedef struct {
+    char task_name[TASK_NAME_LEN]; // By name, so catalog reordering does not break restores
+    int32_t instance_id;
+    int32_t reservation;           // Index into the saved reservations, -1 for the shared pool
+    int64_t offset_ms;
+    int64_t period_ms;             // Assigned period, above nominal while compressed
+    int64_t anchor_ns;             // Upcoming release relative to the epoch, -1 if unknown
+} CheckpointEntry;
+
+/**
+ * One tenant reservation as saved in the state file.
+ */
+typedef struct {
+    char name[TASK_NAME_LEN]; // Empty for a free entry
+    uint8_t token_hash[SHA256_DIGEST_LEN]; // Tenants keep their tokens across restarts, the file never sees them
+    int64_t budget_ms;
+    int64_t period_ms;
+    int32_t max_instances;
+    int32_t reserved;
+} CheckpointReservation;
+
+/**
+ * Everything a restart needs to resume the admitted set on the same release grid.
+ */
+typedef struct {
+    int64_t epoch_realtime_ns; // Runtime epoch as a CLOCK_REALTIME instant
+    int32_t next_id;
+    int32_t count;
+    CheckpointReservation reservations[MAX_RESERVATIONS];
+    CheckpointEntry entries[MAX_INSTANCES];
+} CheckpointState;
+
+/**
+ * Maps the state file, creating or re-initializing it if it is missing or
+ * not a valid state file, and starts the background flusher.
+ * @return 0 on success, -1 on I/O error.
+ */
+int checkpoint_open(const char *path);
+
+/**
+ * Returns true once a state file is open.
+ */
+bool checkpoint_enabled(void);
+
+/**
+ * Reads the newest intact state. Each save goes to the older of two slots,
+ * so a save torn by a crash leaves the previous state readable.
+ * @return 0 on success, -1 if the file holds no valid state.
+ */
+int checkpoint_load(CheckpointState *out);
+
+/**
+ * Writes 'state' into the mapping and schedules a flush. Returns without
+ * waiting for the disk: saves within CHECKPOINT_FLUSH_MS share one msync.
+ * Single writer: only the supervisor may call it.
+ */
+void checkpoint_save(const CheckpointState *state);
+
+/**
+ * Flushes pending saves, stops the flusher and unmaps the file.
+ */
+void checkpoint_close(void);
+
+#endif
@@ -8,32 +8,33 @@
 #define BACKLOG_SIZE 5
 #define NET_BUFFER_SIZE 4096
 #define NET_RESPONSE_BUF_SIZE 4096
+#define NET_OUTPUT_QUEUE_SIZE (4 * NET_RESPONSE_BUF_SIZE) // Reply bytes held per client while it does not read
+#define SHM_CHANNEL_NAME "/dpt_control"
+#define SHM_SLOTS 16 // Requests in flight over the shared-memory channel
 
-#define N_TASKS 3
+#define N_TASKS 4
 #define MAX_INSTANCES 20
 #define MAX_QUEUE_SIZE 20
 #define TASK_NAME_LEN 32
+#define MAX_RESERVATIONS 8 // Tenant reservations created by RESERVE
+#define MAX_ANALYSIS_TASKS (MAX_INSTANCES + MAX_RESERVATIONS + 4) // Plus candidate, aperiodic server, network and supervisor
+#define MAX_HYPERPERIOD_MS 60000
+#define TRACE_PATH_LEN 64
+#define ACCESS_TOKEN_LEN 33 // Up to 32 characters: the --admin-token and the tenant tokens issued by RESERVE
+#define APERIODIC_QUEUE_SIZE 64
+#define CYCLIC_MAX_FRAMES 4096
+#define NETWORK_PRIORITY 99
+#define SUPERVISOR_PRIORITY 98
+#define TASK_PRIORITY_MAX 90 // Top of the task range, below the control threads
+#define IDLE_PRIORITY 1 // Below every task: runs only when the task core has no job pending
+#define CONTROL_INTERVAL_MS 100
+#define CONTROL_COMMAND_BUDGET 50  // Commands served per interval by the network thread
+#define CONTROL_EVENT_BUDGET 20    // Events handled per interval by the supervisor
+#define OVERHEAD_MARGIN 2.0
+#define CHECKPOINT_FLUSH_MS 50 // Saves within this delay share one msync
+#define TASK_CANCEL_POLL_US 100 // Job CPU time between two preemption points in task_run_for
+#define PROFILE_MIN_SAMPLES 100
+#define PROFILE_DEFAULT_MARGIN 1.2
 #include <poll.h>
-#include "task_config.h"
-#include "task.h"
-
-static void task_A(void);
-
-static void task_B(void);
-
-static void task_C(void);
-
-static TasksConfig tasks_config = {
-    .tasks = {
-        {"t1", 50, 300, 150, task_A},
-        {"t2", 100, 500, 200, task_B},
-        {"t3", 200, 1000, 1000, task_C}
-    }
-};
-
-static void task_A(void) { task_run_for(&tasks_config, 50); }
-static void task_B(void) { task_run_for(&tasks_config, 100); }
-static void task_C(void) { task_run_for(&tasks_config, 200); }
-
 
 #endif
@@ -0,0 +1,59 @@
+#ifndef CYCLIC_H
+#define CYCLIC_H
+
+#include "admission.h"
+#include "analysis.h"
+
+/**
+ * One job slot of a cyclic schedule. Times are in ms relative to the start
+ * of the hyperperiod cycle the job executes in; a job released near the end
+ * of the previous cycle has a negative release.
+ */
+typedef struct {
+    int ref;          // Index of the task in the set the table was built from
+    int instance_id;
+    long start_ms;    // Planned start: frame start plus the jobs before it
+    long release_ms;
+    long deadline_ms; // Absolute deadline within the cycle
+} CyclicEntry;
+
+/**
+ * Static schedule over one hyperperiod, split into equal frames.
+ * Frame f runs entries[frame_first[f]] .. entries[frame_first[f + 1] - 1] back to back.
+ */
+typedef struct CyclicTable {
+    long hyperperiod_ms;
+    long frame_ms;
+    int frame_count;
+    int *frame_first;
+    CyclicEntry *entries;
+    int entry_count;
+    unsigned int generation; // Set by the runtime: orders the tables handed to the executive
+} CyclicTable;
+
+/**
+ * Processor time the executive does not own: threads that preempt it and the
+ * cost of waking up at each frame start. A frame fits only if its jobs still
+ * finish within the frame and by their deadlines under this interference.
+ */
+typedef struct {
+    const AnalysisTask *threads; // Higher-priority threads on the same core
+    int count;
+    long long frame_overhead_us;
+} CyclicInterference;
+
+/**
+ * Builds a table for the set using each entry's assigned period and offset.
+ * The frame is the largest divisor of the hyperperiod, not shorter than any WCET,
+ * for which earliest-deadline-first packing meets every deadline.
+ * An empty set gives a table without frames. The executive has no criticality
+ * mode switch, so HI tasks are given their C_HI budget.
+ * @param intf Interference to leave room for, or NULL for none.
+ * @return The table (free with cyclic_free), or NULL if none was found or
+ *         memory ran out.
+ */
+CyclicTable *cyclic_build(const Task *set, int count, const CyclicInterference *intf);
+
+void cyclic_free(CyclicTable *table);
+
+#endif
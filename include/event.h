@@ -1,6 +1,7 @@
 #ifndef EVENT_H
 #define EVENT_H
 
+#include <stdbool.h>
 #include "constants.h"
 
 typedef enum {
@@ -9,17 +10,95 @@ typedef enum {
     EV_DEACTIVATE,
     EV_LIST,
     EV_INFO,
-    EV_SHUTDOWN
+    EV_SHUTDOWN,
+    EV_METRICS,
+    EV_TRACE,
+    EV_SUBMIT,
+    EV_RESERVE,
+    EV_UNRESERVE,
+    EV_TENANT,
+    EV_ADMIN
 } EventType;
 
+/**
+ * Outcome of a command. TCP clients receive it as text, shared-memory clients as is.
+ */
+typedef enum {
+    STATUS_OK = 0,
+    STATUS_ERR_INVALID_COMMAND,
+    STATUS_ERR_UNKNOWN_TASK,
+    STATUS_ERR_SCHEDULABILITY,
+    STATUS_ERR_SYSTEM_FULL,
+    STATUS_ERR_INVALID_ID,
+    STATUS_ERR_SYSTEM_BUSY,
+    STATUS_ERR_NO_APERIODIC_SERVER,
+    STATUS_ERR_EXCEEDS_SERVER_BUDGET,
+    STATUS_ERR_SERVER_QUEUE_FULL,
+    STATUS_ERR_TRACE_DUMP,
+    STATUS_ERR_UNKNOWN_RESERVATION,
+    STATUS_ERR_RESERVATION_IN_USE,
+    STATUS_ERR_PERMISSION_DENIED,
+    STATUS_COUNT
+} EventStatus;
+
+typedef enum {
+    REPLY_TCP = 0, // client_fd is a socket
+    REPLY_SHM      // client_fd is a shared-memory channel slot
+} ReplyChannel;
+
+typedef enum {
+    TRACE_ACTION_START = 0,
+    TRACE_ACTION_STOP,
+    TRACE_ACTION_DUMP
+} TraceAction;
+
 typedef struct {
     EventType type;
 
     union {
-        char task_name[TASK_NAME_LEN];
+        struct {
+            char task_name[TASK_NAME_LEN];
+            long offset_ms; // Release phase relative to the runtime epoch
+        } activate;
         long target_id;
+        struct {
+            long offset; // First entry to return
+            long limit;  // Maximum entries, 0 for all
+        } list;
+        struct {
+            char task_name[TASK_NAME_LEN];
+        } submit;
+        struct {
+            TraceAction action;
+            char file[TRACE_PATH_LEN]; // Plain file name inside the trace directory
+        } trace;
+        struct {
+            char name[TASK_NAME_LEN];
+            long budget_ms;
+            long period_ms;
+            int max_instances; // MAX_INSTANCES if not given
+        } reserve;
+        struct {
+            char name[TASK_NAME_LEN];
+        } unreserve;
+        struct {
+            char name[TASK_NAME_LEN];
+            char token[ACCESS_TOKEN_LEN]; // Issued by RESERVE
+        } tenant;
+        struct {
+            char token[ACCESS_TOKEN_LEN];
+        } admin;
     } payload;
 
+    // Reservation of the client: ACTIVATE and DEACTIVATE stay within it. Empty for the shared pool.
+    // Filled in by the TCP server from the TENANT binding of the connection, by shared-memory clients directly.
+    char tenant[TASK_NAME_LEN];
+    char token[ACCESS_TOKEN_LEN]; // Token of 'tenant'; not checked for admin clients
+    // RESERVE, UNRESERVE and stopping other clients' instances. Set by the TCP server after
+    // ADMIN, and by the shared-memory server for every request: its channel is owner-only.
+    bool admin;
+
+    ReplyChannel channel;
     int client_fd;
 } Event;
 
@@ -32,4 +111,23 @@ typedef struct {
  */
 int event_parse(const char *line, int client_fd, Event *out_event);
 
+/**
+ * Checks an Event built by a client rather than by event_parse, with the
+ * same rules, and terminates its strings.
+ * @return 0 if valid, -1 otherwise.
+ */
+int event_validate(Event *ev);
+
+/**
+ * Compares two NUL-padded ACCESS_TOKEN_LEN buffers in constant time.
+ * An empty 'expected' token matches nothing.
+ * @return true if they are equal.
+ */
+bool event_token_equal(const char *expected, const char *given);
+
+/**
+ * Protocol text of a status, e.g. "ERR Schedulability". "OK" for STATUS_OK.
+ */
+const char *event_status_text(EventStatus status);
+
 #endif
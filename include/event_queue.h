@@ -1,5 +1,6 @@
 #ifndef EVENT_QUEUE_H
 #define EVENT_QUEUE_H
+#include <pthread.h>
 #include "event.h"
 
 typedef struct {
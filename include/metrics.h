@@ -0,0 +1,84 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stddef.h>
+
+typedef enum {
+    METRIC_COMMANDS = 0,
+    METRIC_INVALID_COMMANDS,
+    METRIC_QUEUE_REJECTS,
+    METRIC_ADMISSIONS,
+    METRIC_REJECT_UNKNOWN,
+    METRIC_REJECT_UTILIZATION,
+    METRIC_REJECT_RTA,
+    METRIC_REJECT_FULL,
+    METRIC_DEACTIVATIONS,
+    METRIC_CONNECTIONS,
+    METRIC_CONNECTIONS_REJECTED,
+    METRIC_JOBS,
+    METRIC_DEADLINE_MISSES,
+    METRIC_JOBS_CANCELLED,
+    METRIC_JOBS_DROPPED,
+    METRIC_JOBS_OVERRUN,
+    METRIC_MODE_SWITCHES,
+    METRIC_BUDGET_THROTTLES,
+    METRIC_BUSY_NS,
+    METRIC_APERIODIC_SUBMITTED,
+    METRIC_APERIODIC_COMPLETED,
+    METRIC_APERIODIC_REJECTED,
+    METRIC_COUNTER_COUNT
+} MetricCounter;
+
+typedef enum {
+    GAUGE_QUEUE_DEPTH = 0,
+    GAUGE_QUEUE_HIGH_WATER,
+    GAUGE_CONNECTIONS_OPEN,
+    GAUGE_ACTIVE_INSTANCES,
+    GAUGE_ADMITTED_UTILIZATION_PPM,
+    GAUGE_CRITICALITY_MODE,
+    GAUGE_RESERVATIONS,
+    METRIC_GAUGE_COUNT
+} MetricGauge;
+
+/**
+ * Resets all counters and gauges.
+ * @param task_cpu The task core, used as label of the per-core series.
+ */
+void metrics_init(int task_cpu);
+
+/**
+ * Lock-free updates, safe from any thread including real-time tasks.
+ */
+void metrics_inc(MetricCounter counter);
+
+void metrics_add(MetricCounter counter, unsigned long long value);
+
+void metrics_gauge_set(MetricGauge gauge, long long value);
+
+void metrics_gauge_add(MetricGauge gauge, long long delta);
+
+/**
+ * Raises the gauge to 'value' if it is currently lower (high-water marks).
+ */
+void metrics_gauge_max(MetricGauge gauge, long long value);
+
+/**
+ * Formats every metric in the Prometheus text exposition format.
+ * Takes no lock: each value is read atomically.
+ * @return The number of bytes written (excluding the terminator).
+ */
+int metrics_format(char *buf, size_t len);
+
+/**
+ * Starts a local HTTP endpoint (127.0.0.1) serving metrics_format() on any path.
+ * The thread runs with the default policy on the caller's CPU affinity.
+ * @return 0 on success, -1 on failure.
+ */
+int metrics_http_start(int port);
+
+/**
+ * Stops and joins the HTTP endpoint thread, if started.
+ */
+void metrics_http_stop(void);
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef OVERHEAD_H
+#define OVERHEAD_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+
+/**
+ * Host costs charged by the schedulability analysis, in microseconds.
+ * All zero means overheads are ignored (e.g. in the simulator).
+ */
+typedef struct {
+    long long context_switch_us; // One switch between two threads on the task core
+    long long release_us;        // Timer expiry to thread running, 99th percentile
+    long long command_us;        // Network thread time for the costliest command: read, parse, format, reply
+    long long event_us;          // Supervisor time for one event: admission test of a full set, thread spawn
+} OverheadModel;
+
+/**
+ * Fixed-window rate limiter of the control plane, lock-free so that several
+ * command transports can draw on one budget.
+ * Windows are CONTROL_INTERVAL_MS long and aligned on CLOCK_MONOTONIC.
+ */
+typedef struct {
+    atomic_ullong state; // Window number << CONTROL_WINDOW_BITS | admissions in that window
+} ControlWindow;
+
+/**
+ * Measures the overheads on 'cpu' with short micro-benchmarks (~0.5 s).
+ * Runs at the top task priority when permitted. Command and event costs are
+ * typical values inflated by OVERHEAD_MARGIN.
+ * @return 0 on success, -1 if a benchmark could not run (the model is then zeroed).
+ */
+int overhead_calibrate(int cpu, OverheadModel *out);
+
+/**
+ * Cost added to the WCET of every job: its release plus being switched in and out.
+ */
+long long overhead_job_us(const OverheadModel *model);
+
+/**
+ * Returns true if the current window has room left under 'budget' (0 = unlimited).
+ */
+bool control_window_available(ControlWindow *win, int budget);
+
+/**
+ * Consumes one unit of the current window.
+ * @return true if it was available, false if the budget is exhausted.
+ */
+bool control_window_take(ControlWindow *win, int budget);
+
+/**
+ * Sleeps until the next window starts.
+ */
+void control_window_wait(void);
+
+#endif
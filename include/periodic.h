@@ -0,0 +1,43 @@
+#ifndef PERIODIC_H
+#define PERIODIC_H
+
+/**
+ * Release clock of one periodic instance, in nanoseconds relative to the
+ * shared epoch. Used by the runtime threads and by the simulator so that
+ * both follow the same release and deadline rules.
+ */
+typedef struct {
+    long long offset_ns;
+    long long nominal_period_ns;
+    long long period_ns;  // Current period, above nominal while compressed
+    long long release_ns; // Release of the current job
+} PeriodicClock;
+
+/**
+ * Anchors the clock to the first grid release epoch + offset + k * period
+ * that is not before 'now_ns'.
+ */
+void periodic_init(PeriodicClock *clk, long long offset_ns, long long nominal_period_ns, long long period_ns,
+                   long long now_ns);
+
+/**
+ * Like periodic_init(), but continues a release sequence that was running
+ * before a restart: while compressed, the releases stay on anchor + k * period
+ * instead of snapping to the epoch grid.
+ * @param anchor_ns Any past or future release of the sequence, -1 if unknown.
+ */
+void periodic_resume(PeriodicClock *clk, long long offset_ns, long long nominal_period_ns, long long period_ns,
+                     long long anchor_ns, long long now_ns);
+
+/**
+ * Moves to the next release using 'period_ns' from now on.
+ * Returning to the nominal period re-aligns the releases to the epoch grid.
+ */
+void periodic_advance(PeriodicClock *clk, long long period_ns);
+
+/**
+ * Absolute deadline of the current job.
+ */
+long long periodic_deadline(const PeriodicClock *clk, long long deadline_ns);
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include "task_config.h"
+
+/**
+ * Observed execution-time statistics of one TaskType, in milliseconds.
+ * Execution time is thread CPU time, so preemptions are not counted.
+ */
+typedef struct {
+    unsigned long long samples;
+    double max_ms;
+    double p99_ms;
+    double evt_ms; // Gumbel (EVT) estimate, < 0 until enough block maxima are collected
+    unsigned long long overruns; // Jobs abandoned past their C_LO, not in the samples
+} WcetProfile;
+
+/**
+ * Resets the statistics of every task of the catalog.
+ * Histogram resolution is derived from each declared WCET.
+ */
+void profiler_init(const TasksConfig *config);
+
+/**
+ * Records one job execution time. Called from the task threads.
+ * @param task Index of the TaskType in the catalog.
+ */
+void profiler_record(int task, long long exec_ns);
+
+/**
+ * Records a job abandoned past its C_LO after 'exec_ns'. It is not a
+ * sample, since its execution was cut short, but the maximum, and with it
+ * the measured bound, is raised to at least 'exec_ns'.
+ */
+void profiler_record_overrun(int task, long long exec_ns);
+
+/**
+ * Computes a snapshot of the statistics of one task.
+ */
+void profiler_get(int task, WcetProfile *out);
+
+/**
+ * Returns the measured execution-time bound (the EVT estimate, or the
+ * observed maximum while too few samples exist, whichever is larger).
+ * @return The bound in ms, or a negative value if fewer than PROFILE_MIN_SAMPLES jobs ran.
+ */
+double profiler_bound_ms(int task);
+
+#endif
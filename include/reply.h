@@ -0,0 +1,21 @@
+#ifndef REPLY_H
+#define REPLY_H
+
+#include <stdbool.h>
+#include "event.h"
+
+/**
+ * Answers a command on the channel it came from. TCP clients receive the
+ * protocol text ("OK ID=3", "ERR Schedulability"), shared-memory clients the
+ * typed status and value.
+ * @param value Instance ID for ACTIVATE, job number for SUBMIT, ignored otherwise.
+ */
+void reply_status(const Event *ev, EventStatus status, long long value);
+
+/**
+ * Answers a command with text (LIST, INFO, METRICS, TRACE), in one or more
+ * chunks. The first chunk starts the reply and the last one completes it.
+ */
+void reply_text(const Event *ev, EventStatus status, const char *text, bool first, bool last);
+
+#endif
@@ -0,0 +1,21 @@
+#ifndef SHA256_H
+#define SHA256_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define SHA256_DIGEST_LEN 32
+
+/**
+ * SHA-256 (FIPS 180-4) of 'len' bytes at 'data'.
+ */
+void sha256(const void *data, size_t len, uint8_t out[SHA256_DIGEST_LEN]);
+
+/**
+ * Compares two digests in constant time.
+ * @return true if they are equal.
+ */
+bool sha256_equal(const uint8_t a[SHA256_DIGEST_LEN], const uint8_t b[SHA256_DIGEST_LEN]);
+
+#endif
@@ -0,0 +1,89 @@
+#ifndef SHM_CHANNEL_H
+#define SHM_CHANNEL_H
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "constants.h"
+#include "event.h"
+
+/*
+ * Shared-memory command channel for controllers on the same host.
+ *
+ * The POSIX shared memory object holds SHM_SLOTS request slots. A client
+ * claims a free slot, writes an Event, marks it REQUEST and rings the server
+ * doorbell. The server thread answers in the same slot and marks it DONE.
+ * Both sides sleep on futexes in the mapping: the server on the doorbell,
+ * the client on its slot state. No parsing and no text formatting happen on
+ * this path, except for the replies that are text by nature (LIST, INFO,
+ * METRICS, TRACE).
+ */
+
+#define SHM_CHANNEL_MAGIC "DPTSHM01"
+
+typedef enum {
+    SHM_SLOT_FREE = 0,
+    SHM_SLOT_CLAIMED,  // A client is writing the request
+    SHM_SLOT_REQUEST,  // Waiting for the server
+    SHM_SLOT_SERVING,  // Taken by the server; the reply may come from the supervisor
+    SHM_SLOT_DONE,     // Reply ready
+    SHM_SLOT_ABANDONED // The client gave up; the server frees the slot when it answers
+} ShmSlotState;
+
+typedef struct {
+    atomic_uint state; // ShmSlotState, also the client's futex word
+    int32_t status;    // EventStatus
+    int64_t value;     // Instance ID of ACTIVATE, job number of SUBMIT
+    Event request;
+    uint32_t text_len;
+    char text[NET_RESPONSE_BUF_SIZE];
+} __attribute__((aligned(64))) ShmSlot;
+
+typedef struct {
+    char magic[8];
+    uint32_t slot_count;
+    uint32_t slot_size;   // Catches a client built with other limits
+    atomic_uint doorbell; // Bumped by every request, the server's futex word
+    atomic_uint sleeping; // Set while the server waits on the doorbell
+    ShmSlot slots[SHM_SLOTS];
+} ShmChannel;
+
+/**
+ * Typed result of a shared-memory command.
+ */
+typedef struct {
+    EventStatus status;
+    long long value;
+} ShmResult;
+
+/**
+ * Blocks while '*word' equals 'expected', at most 'timeout_ns' (< 0 waits forever).
+ * Works across processes sharing the mapping.
+ */
+void shm_futex_wait(atomic_uint *word, unsigned int expected, long long timeout_ns);
+
+/**
+ * Wakes up to 'count' waiters on 'word'.
+ */
+void shm_futex_wake(atomic_uint *word, int count);
+
+/**
+ * Maps the channel of a running server.
+ * @return The mapping, or NULL if no compatible channel exists under 'name'.
+ */
+ShmChannel *shm_client_open(const char *name);
+
+/**
+ * Unmaps a channel returned by shm_client_open.
+ */
+void shm_client_close(ShmChannel *ch);
+
+/**
+ * Sends 'req' and waits for its reply. Spins briefly before sleeping, so a
+ * reply served on another core is picked up without a wake-up.
+ * @param text Receives the text part of the reply (may be NULL).
+ * @return 0 on success, -1 if no slot freed up or no reply came within 'timeout_ms'.
+ */
+int shm_client_call(ShmChannel *ch, const Event *req, ShmResult *out, char *text, size_t text_size, int timeout_ms);
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef SHM_SERVER_H
+#define SHM_SERVER_H
+
+#include <stdbool.h>
+#include "event.h"
+#include "supervisor.h"
+
+/**
+ * Creates the shared-memory command channel 'name' (e.g. "/dpt_control"),
+ * replacing a stale one left by a previous run.
+ * @return 0 on success, -1 on failure.
+ */
+int shm_server_init(const char *name);
+
+/**
+ * Returns true once the channel exists.
+ */
+bool shm_server_enabled(void);
+
+/**
+ * Serves every pending request, or sleeps on the doorbell for at most
+ * 100 ms when there is none. Requests draw on the same command budget as
+ * TCP commands; once it is spent they wait in their slots.
+ */
+void shm_server_poll(Supervisor *spv);
+
+/**
+ * Appends text to the reply in 'slot'; 'first' discards what a previous
+ * request left. Text beyond the slot capacity is cut and the reply ends with
+ * a "[truncated]" line. Paged replies (LIST) stop at the slot size instead.
+ */
+void shm_server_append(int slot, const char *text, bool first);
+
+/**
+ * Completes the reply in 'slot' and wakes its client.
+ */
+void shm_server_complete(int slot, EventStatus status, long long value);
+
+/**
+ * Unmaps and removes the channel.
+ */
+void shm_server_cleanup(void);
+
+#endif
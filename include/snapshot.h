@@ -0,0 +1,30 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "admission.h"
+
+/**
+ * Immutable copy of the active set and the reservation table as published by
+ * the supervisor. The entries still point into the live table: readers map
+ * them to a slot and read the copy.
+ */
+typedef struct {
+    unsigned long version; // Increases with every publication
+    int count;
+    Task entries[MAX_INSTANCES];
+    Reservation reservations[MAX_RESERVATIONS];
+} ActiveSnapshot;
+
+/**
+ * Publishes a new version of the active set and the reservation table.
+ * Single writer: only the supervisor thread may call it.
+ */
+void snapshot_publish(const Task *set, int count, const Reservation *reservations);
+
+/**
+ * Copies the latest consistent version without taking any lock.
+ * Retries while a publication is in progress; never blocks the writer.
+ */
+void snapshot_read(ActiveSnapshot *out);
+
+#endif
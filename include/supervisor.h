@@ -4,19 +4,18 @@
 #include <stdatomic.h>
 #include "event.h"
 #include "event_queue.h"
+#include "admission.h"
+#include "checkpoint.h"
 #include "task.h"
 
-typedef struct {
-    const TaskType *type;
-    int instance_id;
-} Task;
-
 typedef struct {
     atomic_bool running;
     EventQueue queue;
     Task active_set[MAX_INSTANCES];
     int active_count;
     pthread_mutex_t active_mutex;
+    AdmissionPolicy admission;
+    ControlWindow command_window; // Command budget shared by every transport
 } Supervisor;
 
 /**
@@ -30,6 +29,36 @@ void supervisor_init(Supervisor *supervisor);
  */
 void supervisor_loop(Supervisor *supervisor);
 
+/**
+ * Re-admits a checkpointed active set before the control plane starts.
+ * The saved set is tested once as a whole and restarted with its IDs, offsets
+ * and release phases; if it no longer passes, entries are admitted one by one
+ * and the ones that do not fit are dropped.
+ * @return The number of instances restarted.
+ */
+int supervisor_restore(Supervisor *supervisor, const CheckpointState *state);
+
+/**
+ * Routes a parsed command: LIST, INFO and METRICS are answered on the calling
+ * thread, everything else is queued for the supervisor.
+ * Called from the command transports (network and shared-memory threads).
+ */
+void supervisor_dispatch(Supervisor *supervisor, Event ev);
+
+/**
+ * Answers LIST from the latest active set snapshot, without locks.
+ * Honors the optional offset and limit; large sets are streamed in chunks.
+ * Called from the network thread.
+ */
+void supervisor_serve_list(const Supervisor *supervisor, Event ev);
+
+/**
+ * Answers INFO from the catalog, the profiler and the active set and
+ * reservation snapshot, without locks.
+ * Called from the network thread.
+ */
+void supervisor_serve_info(const Supervisor *supervisor, Event ev);
+
 /**
  * Thread-safe queue insertion.
  */
@@ -2,24 +2,69 @@
 #define TASK_H
 
 #include <stdbool.h>
+#include <stdatomic.h>
 #include <pthread.h>
 #include "constants.h"
 
+/**
+ * Criticality level of a task type, and the mode the runtime is in.
+ * In HI mode only CRIT_HI instances run; they are guaranteed their wcet_hi_ms.
+ */
+typedef enum {
+    CRIT_LO = 0,
+    CRIT_HI
+} Criticality;
+
+struct CancelToken;
+
+/**
+ * CPU budget of a tenant reservation, shared by its instances. The runtime
+ * closes the gate once the budget of the current period is spent; a job
+ * reaching a preemption point then waits in 'wait' until it is replenished.
+ */
+typedef struct BudgetGate {
+    atomic_bool closed;
+    void (*wait)(struct BudgetGate *gate, const struct CancelToken *cancel); // Returns early if cancelled
+} BudgetGate;
+
+/**
+ * Cancellation request for the job in progress. Set by the supervisor on
+ * DEACTIVATE, polled by the routine at its preemption points.
+ */
+typedef struct CancelToken {
+    atomic_bool requested;
+    const atomic_bool *abandon; // Also ends the job when set: the HI-mode flag for LO instances, else NULL
+    atomic_bool overrun;        // Also ends the job: set by the C_LO timer of a LO job, cleared at every release
+    BudgetGate *gate;           // Reservation the instance runs in, NULL for the shared pool
+} CancelToken;
+
 typedef struct {
     const char name[TASK_NAME_LEN];
-    const long wcet_ms;
+    const long wcet_ms;       // C_LO: budget in LO mode, the only WCET of a LO task
+    const long wcet_hi_ms;    // C_HI >= wcet_ms for CRIT_HI types, unused for CRIT_LO
+    const Criticality criticality;
     const long period_ms;
     const long deadline_ms;
+    const long period_max_ms; // Elastic range [period_ms, period_max_ms], 0 if rigid
+    const double elasticity;  // Buttazzo elastic coefficient, 0 if rigid
 
-    void (* const routine_fn)(void);
+    // 'cancel' is NULL for jobs that cannot be cancelled (aperiodic jobs)
+    void (* const routine_fn)(const CancelToken *cancel);
 } TaskType;
 
 typedef struct {
     int id;
     pthread_t thread;
     const TaskType *type;
-    volatile bool stop;
+    long offset_ms;
+    atomic_long period_ms; // Current period, may be stretched by elastic compression
+    atomic_llong release_ns; // Upcoming release relative to the epoch, -1 until the thread runs
+    long long anchor_ns;     // Release phase restored from a checkpoint, -1 for a new instance
+    long long budget_ns;     // C_LO admitted with, the overrun timer of shared pool jobs
+    CancelToken cancel; // Stops the thread between jobs and the routine inside one
     bool active;
+    bool retired;            // Cyclic mode: stopped, but still referenced by the executive's table
+    unsigned int retired_at; // Generation of the first table built without it
 } TaskInstance;
 
 // forward declaration
@@ -32,10 +77,43 @@ typedef struct TasksConfig TasksConfig;
  */
 void task_run(double i);
 
+/**
+ * WCET of 'type' while the runtime is in 'mode': C_HI for a HI type in HI mode, C_LO otherwise.
+ */
+long task_wcet_ms(const TaskType *type, Criticality mode);
+
+/**
+ * Returns true once cancellation has been requested, or once a LO job is
+ * abandoned by a switch to HI mode or by running past its C_LO.
+ * A NULL token is never cancelled.
+ * Cheap enough to be called from inner loops.
+ */
+bool task_cancelled(const CancelToken *cancel);
+
+/**
+ * Preemption point of a routine: waits here while the reservation of the job
+ * is out of budget, then reports cancellation like task_cancelled().
+ * Routines that do not use task_run_for() should call it at least every
+ * TASK_CANCEL_POLL_US of work.
+ */
+bool task_preemption_point(const CancelToken *cancel);
+
 /**
  * Executes the dummy workload for a specific duration.
  * Relies on the calibrated `loops_per_ms` to determine how many iterations to run.
+ * Passes a preemption point every TASK_CANCEL_POLL_US of work, so a cancelled
+ * or throttled job runs for at most that much more CPU time.
  * @param ms The target execution time in milliseconds (WCET).
+ * @param cancel Token of the job (may be NULL).
+ * @return true if the work completed, false if it was cancelled.
+ */
+bool task_run_for(const TasksConfig* config, long ms, const CancelToken *cancel);
+
+/**
+ * Executes the dummy workload until the calling thread has used 'ms' of CPU
+ * time, measured rather than derived from the calibration: for routines that
+ * must really exceed a budget.
+ * @return true if the work completed, false if it was cancelled.
  */
-void task_run_for(const TasksConfig* config, long ms);
+bool task_run_cpu_for(const TasksConfig* config, long ms, const CancelToken *cancel);
 #endif
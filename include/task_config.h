@@ -12,6 +12,11 @@ struct TasksConfig {
     unsigned long long loops_per_ms;
 };
 
+/**
+ * The task catalog shared by every subsystem (defined in task_config.c).
+ */
+extern TasksConfig tasks_config;
+
 /**
  * Performs CPU calibration to determine loops_per_ms.
  * Initializes the static task catalog.
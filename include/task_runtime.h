@@ -1,23 +1,90 @@
 #ifndef TASK_RUNTIME_H
 #define TASK_RUNTIME_H
 #include "task.h"
+#include "admission.h"
+
+typedef enum {
+    RUNTIME_THREADS = 0, // One SCHED_FIFO thread per instance
+    RUNTIME_CYCLIC       // One executive thread running a static table over the hyperperiod
+} RuntimeMode;
 
 /**
  * Initializes the thread pool and synchronization primitives.
+ * Captures the shared epoch all release offsets are relative to.
  * Must be called before creating any instance.
+ * @param cpu The isolated core all task threads are pinned to.
+ * @param mode In cyclic mode the executive thread is started here and every
+ *             change to the set rebuilds its table.
+ * @param policy Admission policy the cyclic tables are built under and the
+ *               C_LO budgets of HI jobs are taken from, so both match what
+ *               admission accepted. Must outlive the runtime.
+ * @return 0 on success, -1 if the executive or the idle detector could not be started.
+ */
+int runtime_init(int cpu, RuntimeMode mode, const AdmissionPolicy *policy);
+
+/**
+ * Sets the budget of reservation 'slot', from the next job of its instances on.
+ * The budget is replenished at every multiple of the period since the epoch.
+ * Once the jobs of the reservation have used it up, they are throttled at
+ * their next preemption point until the replenishment. Threads mode only.
+ * @return 0 on success, -1 if 'slot' is out of range.
  */
-void runtime_init(void);
+int runtime_reserve(int slot, long budget_ms, long period_ms);
 
 /**
  * Spawns a new real-time thread for the given task type.
- * Maps the period to a SCHED_FIFO priority.
+ * The instances of a reservation share its priority and are served in FIFO order.
+ * Jobs are released at epoch + offset + k * period, starting from the
+ * first such instant that is not in the past.
  * @param type Pointer to the task definition (WCET, Period, etc.).
+ * @param offset_ms Release phase relative to the runtime epoch.
+ * @param period_ms Initial period, at least type->period_ms.
+ * @param reservation Slot set by runtime_reserve(), -1 for the shared pool.
+ * @param priority SCHED_FIFO priority, from admission_priorities(). Unused in cyclic mode.
+ * @param wcet_us C_LO the instance was admitted with: a shared pool job that runs past it
+ *                switches to HI mode, or is abandoned if LO. Unused in cyclic mode.
  * @return The assigned instance ID, or -1 if the pool is full.
  */
-int runtime_create_instance(const TaskType *type);
+int runtime_create_instance(const TaskType *type, long offset_ms, long period_ms, int reservation, int priority,
+                            long long wcet_us);
+
+/**
+ * Re-creates an instance saved in a checkpoint, keeping its ID and release phase.
+ * IDs up to 'id' are never assigned again.
+ * @param anchor_ns A release of the saved sequence relative to the epoch, -1 if unknown.
+ *                  Only used while the period is compressed; nominal periods follow the grid.
+ * @return The ID, or -1 if the pool is full or the ID is already running.
+ */
+int runtime_restore_instance(const TaskType *type, int id, long offset_ms, long period_ms, long long anchor_ns,
+                             int reservation, int priority, long long wcet_us);
+
+/**
+ * Upcoming release of an instance relative to the epoch, for checkpoints.
+ * @return The release in ns, or -1 if unknown (cyclic mode, thread not started, invalid ID).
+ */
+long long runtime_next_release_ns(int id);
+
+/**
+ * Changes the period of a running instance, effective from its next release.
+ * Returning to the nominal period re-aligns the releases to the epoch grid.
+ * @return 0 on success, -1 if ID is invalid.
+ */
+int runtime_set_period(int id, long period_ms);
+
+/**
+ * Moves a running instance to another SCHED_FIFO priority, when the ranks
+ * change with the set. A no-op in cyclic mode.
+ * @return 0 on success, -1 if ID is invalid.
+ */
+int runtime_set_priority(int id, int priority);
 
 /**
- * Signals a specific task instance to stop and joins its thread.
+ * Signals a specific task instance to stop and joins its thread. A job in
+ * progress is cancelled at its next preemption point. In cyclic mode there
+ * is no thread: the call waits for the executive to return from the job,
+ * and the slot stays reserved until the executive runs a table without the
+ * instance, so a new instance never clears the cancellation of a job still
+ * referenced by the executive.
  * @param id The instance ID to stop.
  * @return 0 on success, -1 if ID is invalid.
  */
@@ -31,6 +98,32 @@ int runtime_stop_instance(int id);
  */
 int runtime_get_active_instances(TaskInstance **out_instances, int max_len);
 
+/**
+ * Captures what a restart needs to continue the same release grid:
+ * the epoch as a CLOCK_REALTIME instant and the next instance ID.
+ */
+void runtime_resume_point(long long *epoch_realtime_ns, int *next_id);
+
+/**
+ * Moves the epoch back to a saved resume point, before any instance is created.
+ * @return 0 on success, -1 if the saved epoch is in the future or predates
+ *         this boot (the fresh epoch is kept).
+ */
+int runtime_resume(long long epoch_realtime_ns, int next_id);
+
+/**
+ * Current criticality mode. A HI job running past its C_LO CPU time switches
+ * to HI mode: LO jobs are abandoned at their next preemption point and LO
+ * releases are skipped. The first idle instant of the task core switches back.
+ * Always CRIT_LO in cyclic mode.
+ */
+Criticality runtime_criticality_mode(void);
+
+/**
+ * Milliseconds elapsed since the runtime epoch, the time base of release offsets.
+ */
+long long runtime_elapsed_ms(void);
+
 /**
  * Stops all active tasks and cleans up thread resources.
  */
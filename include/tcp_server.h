@@ -1,5 +1,6 @@
 #ifndef NET_CORE_H
 #define NET_CORE_H
+#include <stdbool.h>
 #include "constants.h"
 #include "supervisor.h"
 
@@ -9,6 +10,14 @@ typedef struct {
     struct pollfd poll_fds[MAX_CLIENTS + 1];
     char client_buffers[MAX_CLIENTS + 1][NET_BUFFER_SIZE];
     long client_buf_lens[MAX_CLIENTS + 1];
+    bool client_discard[MAX_CLIENTS + 1]; // Skipping the rest of an oversized line
+    bool client_pending[MAX_CLIENTS + 1]; // Complete lines held back by the command budget
+    char client_tenant[MAX_CLIENTS + 1][TASK_NAME_LEN]; // Reservation bound by TENANT, empty for the shared pool
+    char client_token[MAX_CLIENTS + 1][ACCESS_TOKEN_LEN]; // Token given with TENANT
+    bool client_admin[MAX_CLIENTS + 1]; // Authenticated by ADMIN
+    char client_out[MAX_CLIENTS + 1][NET_OUTPUT_QUEUE_SIZE]; // Reply bytes the socket did not take yet
+    size_t client_out_lens[MAX_CLIENTS + 1];
+    bool client_overflow[MAX_CLIENTS + 1]; // Its queue overflowed: disconnected by the next poll
     int server_fd;
 } TcpServer;
 
@@ -18,17 +27,43 @@ typedef struct {
  */
 int tcp_server_init(TcpServer *svr, int port);
 
+/**
+ * Appends every valid command to 'path' as "<ms since epoch> <command>",
+ * the input format of the dpt_sim simulator.
+ * @return 0 on success, -1 if the file cannot be opened.
+ */
+int tcp_server_record_commands(const char *path);
+
+/**
+ * Sets the token ADMIN must present. Without one, no TCP client is admin.
+ * @return 0 on success, -1 if it is empty or longer than ACCESS_TOKEN_LEN - 1.
+ */
+int tcp_server_set_admin_token(const char *token);
+
 /**
  * Handles I/O multiplexing (poll). Accepts connections and reads data.
- * Passes complete lines to the event parser.
+ * Passes complete lines to the event parser, at most the admission command
+ * budget per control interval: once it is spent, the remaining lines stay
+ * buffered (and unread data in the socket) until the next interval.
+ * TENANT and ADMIN are answered here: they bind the connection, whose later
+ * commands carry the reservation name and token, and the admin flag.
  */
 void tcp_server_poll(Supervisor* spv, TcpServer *svr);
 
 /**
  * Sends a response to a specific client. Safe against broken pipes.
+ * What the socket does not take is queued and sent by the network thread
+ * as the client reads; a client whose queue overflows is disconnected.
+ * Callable from any thread.
  */
 void tcp_server_send_response(int client_fd, const char *msg);
 
+/**
+ * Sends a continuation of a response, without the response prefix.
+ * Never waits for socket space: it is queued behind the rest of the reply.
+ */
+void tcp_server_send_raw(int client_fd, const char *msg);
+
 /**
  * Closes all sockets.
  */
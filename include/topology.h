@@ -0,0 +1,62 @@
+#ifndef TOPOLOGY_H
+#define TOPOLOGY_H
+
+#include <sched.h> // cpu_set_t requires _GNU_SOURCE in the including file
+#include <stdbool.h>
+
+/**
+ * CPU placement of the process threads.
+ * Task threads run on one isolated core (the schedulability analysis is uniprocessor),
+ * while the network and supervisor threads run on housekeeping cores.
+ */
+typedef struct {
+    int task_cpu;
+    cpu_set_t control_cpus;
+    bool control_set; // control_cpus given explicitly (file or command line)
+    int task_node;    // NUMA node of task_cpu, -1 if unknown
+} Topology;
+
+/**
+ * Sets the defaults: tasks on CPU_NUMBER, control cores resolved later.
+ */
+void topology_init(Topology *topo);
+
+/**
+ * Parses a Linux cpulist string (e.g. "0-3,6").
+ * @return 0 on success, -1 on malformed input.
+ */
+int topology_parse_cpulist(const char *list, cpu_set_t *out);
+
+/**
+ * Parses a single CPU number. Whether it is online is checked by topology_resolve().
+ * @return 0 on success, -1 if 'text' is not a number in [0, CPU_SETSIZE).
+ */
+int topology_parse_cpu(const char *text, int *out);
+
+/**
+ * Loads "key = value" lines from a file. Keys: task_cpu, control_cpus.
+ * Lines starting with '#' are ignored.
+ * @return 0 on success, -1 on I/O or parse error.
+ */
+int topology_load_file(Topology *topo, const char *path);
+
+/**
+ * Validates the configuration against the online CPUs and resolves defaults.
+ * Without explicit control cores, picks every online core on the task core's
+ * NUMA node except the task core itself, falling back to the task core.
+ * @return 0 on success, -1 if the task core is not usable.
+ */
+int topology_resolve(Topology *topo);
+
+/**
+ * Returns true if control-plane threads may run on the task core.
+ */
+bool topology_control_shares_task_cpu(const Topology *topo);
+
+/**
+ * Prints the placement and validates the host isolation setup:
+ * isolcpus, nohz_full and the IRQs whose affinity includes the task core.
+ */
+void topology_report(const Topology *topo);
+
+#endif
@@ -0,0 +1,76 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include "constants.h"
+
+#define TRACE_MAGIC "DPTTRACE"
+#define TRACE_VERSION 2
+
+// One ring per pool slot, plus one for the supervisor thread
+#define TRACE_RING_SUPERVISOR MAX_INSTANCES
+#define TRACE_RING_COUNT (MAX_INSTANCES + 1)
+
+typedef enum {
+    TRACE_RELEASE = 1, // Nominal release instant of a job
+    TRACE_START,       // Job starts executing
+    TRACE_END,         // Job completes (arg: execution time in ns)
+    TRACE_SLEEP,       // Thread sleeps until the next release
+    TRACE_MISS,        // Deadline missed (arg: response time in ns)
+    TRACE_ADMIT,       // Supervisor admitted an instance
+    TRACE_REJECT,      // Supervisor rejected an activation
+    TRACE_DEACTIVATE   // Supervisor stopped an instance
+} TraceEventType;
+
+typedef struct {
+    uint64_t ts_ns; // CLOCK_MONOTONIC
+    uint16_t type;
+    uint16_t task;  // Index in the catalog stored in the file header
+    int32_t instance_id;
+    int64_t arg;
+} TraceRecord;
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t task_count;
+    uint64_t record_count;
+    char task_names[N_TASKS][TASK_NAME_LEN];
+} TraceFileHeader;
+
+/**
+ * Enables or disables recording. Disabled recording costs one relaxed atomic load.
+ * Enabling clears all rings: it starts a new generation, and dumps skip the
+ * records of older ones, including a record being written during the call.
+ */
+void trace_start(void);
+
+void trace_stop(void);
+
+/**
+ * Appends a record to a ring. Each ring must have a single writer thread.
+ * Old records are overwritten when the ring is full.
+ * @param ring Pool slot index, or TRACE_RING_SUPERVISOR.
+ */
+void trace_record(int ring, TraceEventType type, int task, int instance_id, int64_t arg, uint64_t ts_ns);
+
+/**
+ * Returns the current CLOCK_MONOTONIC time in nanoseconds.
+ */
+uint64_t trace_now(void);
+
+/**
+ * Sets the directory TRACE DUMP writes into (default: the working directory).
+ */
+void trace_set_dir(const char *dir);
+
+/**
+ * Writes the header and every ring's records to the binary file 'name' in
+ * the trace directory. 'name' comes from clients: it must be a plain file
+ * name, and a symbolic link in its place is not followed.
+ * Safe while recording: records overwritten during the copy are discarded.
+ * @return The number of records written, or -1 on I/O error or an invalid name.
+ */
+long trace_dump(const char *name);
+
+#endif
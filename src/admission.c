@@ -0,0 +1,354 @@
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "constants.h"
+#include "admission.h"
+
+#include "analysis.h"
+#include "cyclic.h"
+#include "profiler.h"
+#include "task_config.h"
+
+#define USEC_PER_MSEC 1000L
+// Equal deadlines rank the aperiodic server first, then the reservations by slot, then the tasks in set order
+#define SERVER_TIEBREAK (-MAX_RESERVATIONS - 1)
+#define RESERVATION_TIEBREAK(slot) ((slot) - MAX_RESERVATIONS)
+
+/*
+ * WCET used by admission: the declared value, or in measured mode the
+ * profiled bound inflated by the safety margin once enough jobs were observed.
+ */
+long long admission_wcet_us(const AdmissionPolicy *policy, const TaskType *type) {
+    if (policy->mode == ADMISSION_MEASURED) {
+        const double bound_ms = profiler_bound_ms((int) (type - tasks_config.tasks));
+        if (bound_ms > 0) return (long long) ceil(bound_ms * policy->wcet_margin * USEC_PER_MSEC);
+    }
+    return type->wcet_ms * USEC_PER_MSEC;
+}
+
+long long admission_task_wcet_us(const AdmissionPolicy *policy, const Task *task) {
+    return task->wcet_us > 0 ? task->wcet_us : admission_wcet_us(policy, task->type);
+}
+
+static void to_analysis_task(const AdmissionPolicy *policy, AnalysisTask *out, const Task *task, const long offset_ms,
+                             const int ref) {
+    const TaskType *type = task->type;
+    const long long hi_us = task_wcet_ms(type, CRIT_HI) * USEC_PER_MSEC + overhead_job_us(&policy->overhead);
+    out->name = type->name;
+    out->wcet_us = admission_task_wcet_us(policy, task) + overhead_job_us(&policy->overhead);
+    if (policy->cyclic && hi_us > out->wcet_us) out->wcet_us = hi_us; // No mode switch on the executive
+    out->wcet_hi_us = hi_us > out->wcet_us ? hi_us : out->wcet_us;
+    out->criticality = type->criticality;
+    out->period_us = type->period_ms * USEC_PER_MSEC;
+    out->deadline_us = type->deadline_ms * USEC_PER_MSEC;
+    out->offset_us = offset_ms * USEC_PER_MSEC;
+    out->period_max_us = (type->period_max_ms > type->period_ms ? type->period_max_ms : type->period_ms) * USEC_PER_MSEC;
+    out->elasticity = type->elasticity;
+    out->jitter_us = 0;
+    out->priority = 0;
+    out->ref = ref;
+    out->tiebreak = ref;
+}
+
+/*
+ * A deferrable server can run its budget at the end of one period and again at
+ * the start of the next: it interferes like a periodic task with jitter T - C.
+ */
+static void server_analysis_task(const AdmissionPolicy *policy, AnalysisTask *out) {
+    out->name = "aperiodic server";
+    out->wcet_us = policy->server_budget_ms * USEC_PER_MSEC + overhead_job_us(&policy->overhead);
+    out->wcet_hi_us = out->wcet_us; // Keeps serving in HI mode
+    out->criticality = CRIT_HI;
+    out->period_us = policy->server_period_ms * USEC_PER_MSEC;
+    out->deadline_us = out->period_us;
+    out->offset_us = 0;
+    out->period_max_us = out->period_us;
+    out->elasticity = 0;
+    out->jitter_us = out->period_us - out->wcet_us;
+    out->priority = 0;
+    out->ref = -1;
+    out->tiebreak = SERVER_TIEBREAK;
+}
+
+/*
+ * A reservation is replenished every period and throttled once its budget is
+ * spent: like the deferrable server it interferes with jitter T - C. A job
+ * notices the throttle at its next preemption point, so the budget can be
+ * overrun by TASK_CANCEL_POLL_US. The members rely on the whole budget being
+ * supplied within each period: D = T.
+ */
+static void reservation_analysis_task(const AdmissionPolicy *policy, AnalysisTask *out, const int slot) {
+    const Reservation *res = &policy->reservations[slot];
+    out->name = res->name;
+    out->wcet_us = res->budget_ms * USEC_PER_MSEC + TASK_CANCEL_POLL_US + overhead_job_us(&policy->overhead);
+    out->wcet_hi_us = out->wcet_us; // Members are never dropped in HI mode
+    out->criticality = CRIT_HI;
+    out->period_us = res->period_ms * USEC_PER_MSEC;
+    out->deadline_us = out->period_us;
+    out->offset_us = 0;
+    out->period_max_us = out->period_us;
+    out->elasticity = 0;
+    out->jitter_us = out->wcet_us < out->period_us ? out->period_us - out->wcet_us : 0;
+    out->priority = 0;
+    out->ref = -1;
+    out->tiebreak = RESERVATION_TIEBREAK(slot);
+}
+
+/*
+ * A control thread serves at most 'budget' requests per fixed window, each
+ * costing 'cost_us' plus being switched in and out (it is woken by I/O, not a
+ * timer). Like the deferrable server, a full window can run at the end of one
+ * interval and again at the start of the next: jitter T - C.
+ */
+static void control_analysis_task(const AdmissionPolicy *policy, AnalysisTask *out, const char *name,
+                                  const long long cost_us, const int budget, const int priority) {
+    out->name = name;
+    out->wcet_us = budget * (cost_us + 2 * policy->overhead.context_switch_us);
+    out->wcet_hi_us = out->wcet_us;
+    out->criticality = CRIT_HI;
+    out->period_us = CONTROL_INTERVAL_MS * USEC_PER_MSEC;
+    out->deadline_us = out->period_us;
+    out->offset_us = 0;
+    out->period_max_us = out->period_us;
+    out->elasticity = 0;
+    out->jitter_us = out->wcet_us < out->period_us ? out->period_us - out->wcet_us : 0;
+    out->priority = priority;
+    out->ref = -1;
+    out->tiebreak = 0;
+}
+
+/*
+ * Tests the LO mode, where every task runs within its C_LO. Sorts 'tasks' in place.
+ * On failure stores the rejection counter in 'reason'.
+ */
+static int check_lo_mode(AnalysisTask *tasks, const int count, const char *name, MetricCounter *reason) {
+    AnalysisMiss miss;
+    int phased = 0;
+
+    for (int i = 0; i < count; i++) {
+        if (tasks[i].offset_us % tasks[i].period_us != 0) phased = 1;
+    }
+
+    // Utilization Test (Necessary Condition)
+    const double util = analysis_utilization(tasks, count);
+    if (util > 1.0) {
+        *reason = METRIC_REJECT_UTILIZATION;
+        printf("[RTA] Rejected %s: Utilization %.2f > 1.0\n", name, util);
+        return 0;
+    }
+
+    // Response Time Analysis (Sufficient Condition, exact for synchronous releases)
+    *reason = METRIC_REJECT_RTA;
+    if (analysis_rta(tasks, count, &miss)) return 1;
+    if (!phased) {
+        printf("[RTA] Rejected %s: R=%.1f > D=%.1f (%s)\n", name,
+               (double) miss.response_us / USEC_PER_MSEC, (double) miss.deadline_us / USEC_PER_MSEC, miss.name);
+        return 0;
+    }
+
+    // Offset-aware simulation over the hyperperiod (Exact Condition for staggered releases at distinct priorities)
+    const int sim = analysis_offset_simulation(tasks, count, &miss);
+    if (sim == 1) {
+        printf("[RTA] Admitted %s by offset analysis\n", name);
+        return 1;
+    }
+    if (sim < 0) {
+        printf("[RTA] Rejected %s: Hyperperiod exceeds %d ms, synchronous RTA failed\n",
+               name, MAX_HYPERPERIOD_MS);
+    } else {
+        printf("[RTA] Rejected %s: R=%.1f > D=%.1f with offsets (%s)\n", name,
+               (double) miss.response_us / USEC_PER_MSEC, (double) miss.deadline_us / USEC_PER_MSEC, miss.name);
+    }
+    return 0;
+}
+
+/*
+ * Tests the HI mode (AMC-rtb). Passes trivially without HI tasks.
+ * On failure stores the rejection counter in 'reason'.
+ */
+static int check_hi_mode(AnalysisTask *tasks, const int count, const char *name, MetricCounter *reason) {
+    AnalysisMiss miss;
+
+    if (analysis_amc_hi(tasks, count, &miss)) return 1;
+    *reason = METRIC_REJECT_RTA;
+    printf("[RTA] Rejected %s: HI-mode R=%.1f > D=%.1f (%s)\n", name,
+           (double) miss.response_us / USEC_PER_MSEC, (double) miss.deadline_us / USEC_PER_MSEC, miss.name);
+    return 0;
+}
+
+/*
+ * Tests the set at nominal periods in both criticality modes. Sorts 'tasks' in place.
+ */
+static int check_nominal(AnalysisTask *tasks, const int count, const char *name, MetricCounter *reason) {
+    return check_lo_mode(tasks, count, name, reason) && check_hi_mode(tasks, count, name, reason);
+}
+
+/*
+ * Higher-priority control threads, if they share the task core.
+ * @return The number of entries written to 'out'.
+ */
+static int control_analysis_tasks(const AdmissionPolicy *policy, AnalysisTask *out) {
+    if (!policy->control_on_task_cpu) return 0;
+    control_analysis_task(policy, &out[0], "network thread", policy->overhead.command_us,
+                          policy->command_budget, NETWORK_PRIORITY);
+    control_analysis_task(policy, &out[1], "supervisor thread", policy->overhead.event_us,
+                          policy->event_budget, SUPERVISOR_PRIORITY);
+    return 2;
+}
+
+/*
+ * The aperiodic server and the reservations, admitted at the top level.
+ * @return The number of entries written to 'out'.
+ */
+static int top_level_analysis_tasks(const AdmissionPolicy *policy, AnalysisTask *out) {
+    int count = 0;
+    if (policy->server_budget_ms > 0) server_analysis_task(policy, &out[count++]);
+    for (int r = 0; r < MAX_RESERVATIONS; r++) {
+        if (policy->reservations[r].name[0] != '\0') reservation_analysis_task(policy, &out[count++], r);
+    }
+    return count;
+}
+
+CyclicTable *admission_cyclic_table(const AdmissionPolicy *policy, const Task *set, const int count) {
+    AnalysisTask control[2];
+    const CyclicInterference intf = {
+        .threads = control,
+        .count = control_analysis_tasks(policy, control),
+        .frame_overhead_us = overhead_job_us(&policy->overhead)
+    };
+    return cyclic_build(set, count, &intf);
+}
+
+/*
+ * Tests the set on the cyclic executive with the periods in 'tasks'.
+ * Jobs never preempt each other there: the schedule table replaces the
+ * fixed-priority tests. On failure stores the rejection counter in 'reason'.
+ */
+static int check_cyclic(const AdmissionPolicy *policy, Task *set, const int set_count, const AnalysisTask *tasks,
+                        const int count, const char *name, MetricCounter *reason) {
+    const double util = analysis_utilization(tasks, count);
+    if (util > 1.0) {
+        *reason = METRIC_REJECT_UTILIZATION;
+        printf("[RTA] Rejected %s: Utilization %.2f > 1.0\n", name, util);
+        return 0;
+    }
+    for (int i = 0; i < count; i++) {
+        if (tasks[i].ref >= 0) set[tasks[i].ref].period_ms = (long) (tasks[i].period_us / USEC_PER_MSEC);
+    }
+
+    CyclicTable *table = admission_cyclic_table(policy, set, set_count);
+    cyclic_free(table);
+    if (!table) {
+        *reason = METRIC_REJECT_RTA;
+        printf("[RTA] Rejected %s: no cyclic schedule table\n", name);
+        return 0;
+    }
+    return 1;
+}
+
+int admission_check(const AdmissionPolicy *policy, const Task *active, const int active_count,
+                    const Task *candidate, long *periods_ms, MetricCounter *reason) {
+    AnalysisTask tasks[MAX_ANALYSIS_TASKS];
+    AnalysisTask nominal[MAX_ANALYSIS_TASKS];
+    Task set[MAX_INSTANCES + 1];
+    const char *name = candidate ? candidate->type->name : "active set";
+    int count = 0;
+
+    for (int i = 0; i < active_count; i++) {
+        set[i] = active[i];
+        if (active[i].reservation) continue; // Counted in its reservation
+        to_analysis_task(policy, &tasks[count++], &active[i], active[i].offset_ms, i);
+    }
+    int set_count = active_count;
+    if (candidate) {
+        set[set_count] = *candidate;
+        set[set_count].instance_id = -1;
+        to_analysis_task(policy, &tasks[count++], candidate, candidate->offset_ms, set_count);
+        set_count++;
+    }
+    count += top_level_analysis_tasks(policy, &tasks[count]);
+    count += control_analysis_tasks(policy, &tasks[count]);
+
+    memcpy(nominal, tasks, sizeof(AnalysisTask) * count);
+    const int ok = policy->cyclic
+                       ? check_cyclic(policy, set, set_count, nominal, count, name, reason)
+                       : check_nominal(nominal, count, name, reason);
+    if (!ok) {
+        // Elastic Compression: run slower rather than reject
+        if (!analysis_elastic(tasks, count)) return 0;
+        if (policy->cyclic && !check_cyclic(policy, set, set_count, tasks, count, name, reason)) return 0;
+        printf("[RTA] Admitted %s by compressing elastic periods\n", name);
+    }
+
+    for (int i = 0; i < active_count; i++) {
+        if (active[i].reservation) periods_ms[i] = active[i].period_ms;
+    }
+    for (int i = 0; i < count; i++) {
+        if (tasks[i].ref >= 0) periods_ms[tasks[i].ref] = (long) (tasks[i].period_us / USEC_PER_MSEC);
+    }
+    return 1;
+}
+
+int admission_priorities(const AdmissionPolicy *policy, const Task *set, const int count, int *priorities) {
+    AnalysisTask tasks[MAX_ANALYSIS_TASKS];
+    int reservation_priorities[MAX_RESERVATIONS] = {0};
+    int server_priority = 0;
+    int n = 0;
+
+    for (int i = 0; i < count; i++) {
+        if (!set[i].reservation) to_analysis_task(policy, &tasks[n++], &set[i], set[i].offset_ms, i);
+    }
+    n += top_level_analysis_tasks(policy, &tasks[n]);
+    analysis_sort(tasks, n);
+
+    // One level per entry, in the order every test assumes
+    for (int k = 0; k < n; k++) {
+        const int priority = TASK_PRIORITY_MAX - k;
+        if (tasks[k].ref >= 0) priorities[tasks[k].ref] = priority;
+        else if (tasks[k].tiebreak == SERVER_TIEBREAK) server_priority = priority;
+        else reservation_priorities[tasks[k].tiebreak + MAX_RESERVATIONS] = priority;
+    }
+    for (int i = 0; i < count; i++) {
+        if (set[i].reservation) priorities[i] = reservation_priorities[set[i].reservation - policy->reservations];
+    }
+    return server_priority;
+}
+
+int admission_check_reservation(const AdmissionPolicy *policy, const Reservation *res, const Task *active,
+                                const int active_count, const Task *candidate, MetricCounter *reason) {
+    AnalysisTask tasks[MAX_INSTANCES + 1];
+    AnalysisMiss miss;
+    const char *name = candidate ? candidate->type->name : res->name;
+    int count = 0;
+
+    for (int i = 0; i < active_count; i++) {
+        if (active[i].reservation == res) to_analysis_task(policy, &tasks[count++], &active[i], 0, i);
+    }
+    if (candidate) to_analysis_task(policy, &tasks[count++], candidate, 0, active_count);
+    // No mode switch inside a reservation: HI members are budgeted at C_HI
+    for (int i = 0; i < count; i++) tasks[i].wcet_us = tasks[i].wcet_hi_us;
+
+    const double util = analysis_utilization(tasks, count);
+    const double share = (double) res->budget_ms / (double) res->period_ms;
+    if (util > share) {
+        *reason = METRIC_REJECT_UTILIZATION;
+        printf("[RTA] Rejected %s: Utilization %.2f > %.2f of reservation %s\n", name, util, share, res->name);
+        return 0;
+    }
+    if (!analysis_reservation(tasks, count, res->budget_ms * USEC_PER_MSEC, res->period_ms * USEC_PER_MSEC, &miss)) {
+        *reason = METRIC_REJECT_RTA;
+        printf("[RTA] Rejected %s: R=%.1f > D=%.1f in reservation %s (%s)\n", name,
+               (double) miss.response_us / USEC_PER_MSEC, (double) miss.deadline_us / USEC_PER_MSEC, res->name,
+               miss.name);
+        return 0;
+    }
+    return 1;
+}
+
+const Reservation *admission_find_reservation(const AdmissionPolicy *policy, const char *name) {
+    for (int r = 0; r < MAX_RESERVATIONS; r++) {
+        const Reservation *res = &policy->reservations[r];
+        if (res->name[0] != '\0' && strncmp(res->name, name, TASK_NAME_LEN) == 0) return res;
+    }
+    return NULL;
+}
@@ -0,0 +1,344 @@
+#include <stdlib.h>
+#include <limits.h>
+#include "constants.h"
+#include "analysis.h"
+
+#define USEC_PER_MSEC 1000LL
+#define ELASTIC_STEP 0.01 // Utilization decrement between compression attempts
+
+static long long ceil_div(const long long a, const long long b) {
+    return (a + b - 1) / b;
+}
+
+static long long gcd(long long a, long long b) {
+    while (b != 0) {
+        const long long t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+static void set_miss(AnalysisMiss *miss, const AnalysisTask *task, const long long response_us) {
+    if (!miss) return;
+    miss->name = task->name;
+    miss->response_us = response_us;
+    miss->deadline_us = task->deadline_us;
+}
+
+static int compare_priority(const void *a, const void *b) {
+    const AnalysisTask *ta = a;
+    const AnalysisTask *tb = b;
+    if (ta->priority != tb->priority) return (ta->priority < tb->priority) ? 1 : -1;
+    if (ta->deadline_us != tb->deadline_us) return (ta->deadline_us > tb->deadline_us) ? 1 : -1;
+    if (ta->tiebreak != tb->tiebreak) return (ta->tiebreak > tb->tiebreak) ? 1 : -1;
+    return 0;
+}
+
+void analysis_sort(AnalysisTask *tasks, const int count) {
+    qsort(tasks, count, sizeof(AnalysisTask), compare_priority);
+}
+
+double analysis_utilization(const AnalysisTask *tasks, const int count) {
+    double util = 0;
+    for (int i = 0; i < count; i++) {
+        util += (double) tasks[i].wcet_us / (double) tasks[i].period_us;
+    }
+    return util;
+}
+
+int analysis_rta(AnalysisTask *tasks, const int count, AnalysisMiss *miss) {
+    analysis_sort(tasks, count);
+
+    for (int i = 0; i < count; i++) {
+        long long R = tasks[i].wcet_us;
+
+        while (1) {
+            long long I = 0;
+            for (int j = 0; j < i; j++) {
+                I += ceil_div(R + tasks[j].jitter_us, tasks[j].period_us) * tasks[j].wcet_us;
+            }
+            const long long R_new = tasks[i].wcet_us + I;
+
+            if (R_new > tasks[i].deadline_us) {
+                set_miss(miss, &tasks[i], R_new);
+                return 0;
+            }
+            if (R_new == R) break;
+            R = R_new;
+        }
+    }
+    return 1;
+}
+
+/*
+ * Computes the Buttazzo compressed utilizations for a desired total 'target'
+ * and writes the resulting periods (rounded up to whole ms) into 'tasks'.
+ * Returns 0 if the target is below the minimum reachable utilization.
+ */
+static int elastic_compress(AnalysisTask *tasks, const long long *nominal, const int count, const double target) {
+    int fixed[MAX_ANALYSIS_TASKS];
+    double util[MAX_ANALYSIS_TASKS];
+
+    for (int i = 0; i < count; i++) {
+        fixed[i] = tasks[i].elasticity <= 0 || tasks[i].period_max_us <= nominal[i];
+        util[i] = (double) tasks[i].wcet_us / (double) nominal[i];
+    }
+
+    int changed = 1;
+    while (changed) {
+        changed = 0;
+        double u_fixed = 0, u_var = 0, e_var = 0;
+        for (int i = 0; i < count; i++) {
+            const double u0 = (double) tasks[i].wcet_us / (double) nominal[i];
+            if (fixed[i]) u_fixed += util[i];
+            else {
+                u_var += u0;
+                e_var += tasks[i].elasticity;
+            }
+        }
+        if (e_var == 0) {
+            if (u_fixed > target) return 0;
+            break;
+        }
+        if (u_fixed >= target) return 0;
+
+        const double excess = u_var - (target - u_fixed);
+        for (int i = 0; i < count; i++) {
+            if (fixed[i]) continue;
+            const double u0 = (double) tasks[i].wcet_us / (double) nominal[i];
+            const double u_min = (double) tasks[i].wcet_us / (double) tasks[i].period_max_us;
+            util[i] = u0 - excess * tasks[i].elasticity / e_var;
+            if (util[i] < u_min) {
+                util[i] = u_min;
+                fixed[i] = 1;
+                changed = 1;
+            }
+        }
+    }
+
+    for (int i = 0; i < count; i++) {
+        long long period = ceil_div((long long) ((double) tasks[i].wcet_us / util[i]), USEC_PER_MSEC) * USEC_PER_MSEC;
+        if (period < nominal[i]) period = nominal[i];
+        if (period > tasks[i].period_max_us) period = tasks[i].period_max_us;
+        tasks[i].period_us = period;
+    }
+    return 1;
+}
+
+int analysis_elastic(AnalysisTask *tasks, const int count) {
+    long long nominal[MAX_ANALYSIS_TASKS];
+    AnalysisTask work[MAX_ANALYSIS_TASKS];
+
+    for (int i = 0; i < count; i++) nominal[i] = tasks[i].period_us;
+    double target = analysis_utilization(tasks, count);
+    if (target > 1.0) target = 1.0;
+
+    for (; target > 0; target -= ELASTIC_STEP) {
+        if (!elastic_compress(tasks, nominal, count, target)) break;
+        for (int i = 0; i < count; i++) work[i] = tasks[i];
+        if (analysis_utilization(work, count) <= 1.0 && analysis_rta(work, count, NULL) &&
+            analysis_amc_hi(work, count, NULL)) return 1;
+    }
+
+    for (int i = 0; i < count; i++) tasks[i].period_us = nominal[i];
+    return 0;
+}
+
+int analysis_amc_hi(AnalysisTask *tasks, const int count, AnalysisMiss *miss) {
+    analysis_sort(tasks, count);
+
+    for (int i = 0; i < count; i++) {
+        if (tasks[i].criticality != CRIT_HI) continue;
+        // An offset-admitted set may exceed the synchronous bound: its LO jobs still end by the deadline
+        long long R_lo = analysis_busy_time(tasks, i, tasks[i].wcet_us, tasks[i].deadline_us);
+        if (R_lo < 0) R_lo = tasks[i].deadline_us;
+        long long R = tasks[i].wcet_hi_us;
+
+        while (1) {
+            long long I = 0;
+            for (int j = 0; j < i; j++) {
+                if (tasks[j].criticality == CRIT_HI) {
+                    I += ceil_div(R + tasks[j].jitter_us, tasks[j].period_us) * tasks[j].wcet_hi_us;
+                } else {
+                    I += ceil_div(R_lo + tasks[j].jitter_us, tasks[j].period_us) * tasks[j].wcet_us;
+                }
+            }
+            const long long R_new = tasks[i].wcet_hi_us + I;
+
+            if (R_new > tasks[i].deadline_us) {
+                set_miss(miss, &tasks[i], R_new);
+                return 0;
+            }
+            if (R_new == R) break;
+            R = R_new;
+        }
+    }
+    return 1;
+}
+
+long long analysis_busy_time(const AnalysisTask *hp, const int count, const long long work_us,
+                             const long long limit_us) {
+    long long R = work_us;
+    while (R <= limit_us) {
+        long long I = 0;
+        for (int j = 0; j < count; j++) {
+            I += ceil_div(R + hp[j].jitter_us, hp[j].period_us) * hp[j].wcet_us;
+        }
+        if (work_us + I == R) return R;
+        R = work_us + I;
+    }
+    return -1;
+}
+
+long long analysis_sbf(const long long budget_us, const long long period_us, const long long t_us) {
+    const long long blackout = period_us - budget_us;
+    if (t_us <= blackout) return 0;
+    const long long periods = (t_us - blackout) / period_us;
+    const long long partial = t_us - 2 * blackout - periods * period_us;
+    return periods * budget_us + (partial > 0 ? partial : 0);
+}
+
+/*
+ * Inverse of the supply bound function: the shortest interval that is
+ * guaranteed to supply 'work_us'.
+ */
+static long long supply_time(const long long budget_us, const long long period_us, const long long work_us) {
+    if (work_us <= 0) return 0;
+    const long long full = ceil_div(work_us, budget_us) - 1; // Periods supplied before the one completing the work
+    return 2 * (period_us - budget_us) + full * period_us + (work_us - full * budget_us);
+}
+
+int analysis_reservation(const AnalysisTask *tasks, const int count, const long long budget_us,
+                         const long long period_us, AnalysisMiss *miss) {
+    const long long limit_us = MAX_HYPERPERIOD_MS * USEC_PER_MSEC;
+    long long L = 0;
+
+    if (count == 0) return 1;
+    if (analysis_utilization(tasks, count) > (double) budget_us / (double) period_us) {
+        set_miss(miss, &tasks[0], -1);
+        return 0;
+    }
+
+    // Busy period of the reservation: everything released at once
+    for (int j = 0; j < count; j++) L += tasks[j].wcet_us;
+    while (1) {
+        long long W = 0;
+        for (int j = 0; j < count; j++) W += ceil_div(L, tasks[j].period_us) * tasks[j].wcet_us;
+        const long long L_new = supply_time(budget_us, period_us, W);
+        if (L_new > limit_us) {
+            set_miss(miss, &tasks[0], L_new);
+            return 0;
+        }
+        if (L_new == L) break;
+        L = L_new;
+    }
+
+    // FIFO: a job waits for everything released up to and including its own release
+    for (int i = 0; i < count; i++) {
+        for (long long a = 0; a < L; a += tasks[i].period_us) {
+            long long W = 0;
+            for (int j = 0; j < count; j++) W += (a / tasks[j].period_us + 1) * tasks[j].wcet_us;
+            const long long R = supply_time(budget_us, period_us, W) - a;
+            if (R > tasks[i].deadline_us) {
+                set_miss(miss, &tasks[i], R);
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+int analysis_offset_simulation(AnalysisTask *tasks, const int count, AnalysisMiss *miss) {
+    long long release[MAX_ANALYSIS_TASKS];
+    long long remaining[MAX_ANALYSIS_TASKS];
+    long long abs_deadline[MAX_ANALYSIS_TASKS];
+    long long charge[MAX_ANALYSIS_TASKS];
+    long long hyperperiod = 1;
+    long long max_phase = 0;
+
+    analysis_sort(tasks, count);
+
+    /*
+     * Jittered entries (deferrable server, control threads) are not periodic:
+     * each is tested by its synchronous busy time and left out of the simulation,
+     * and every job below it is charged the most it can interfere within the
+     * job's deadline window. Sufficient, exact when nothing is jittered.
+     */
+    for (int i = 0; i < count; i++) {
+        charge[i] = tasks[i].wcet_us;
+        for (int j = 0; j < i; j++) {
+            if (tasks[j].jitter_us > 0) {
+                charge[i] += ceil_div(tasks[i].deadline_us + tasks[j].jitter_us, tasks[j].period_us) * tasks[j].wcet_us;
+            }
+        }
+        if (tasks[i].jitter_us > 0 && analysis_busy_time(tasks, i, tasks[i].wcet_us, tasks[i].deadline_us) < 0) {
+            const long long response = analysis_busy_time(tasks, i, tasks[i].wcet_us, MAX_HYPERPERIOD_MS * USEC_PER_MSEC);
+            set_miss(miss, &tasks[i], response < 0 ? MAX_HYPERPERIOD_MS * USEC_PER_MSEC : response);
+            return 0;
+        }
+    }
+
+    for (int i = 0; i < count; i++) {
+        release[i] = LLONG_MAX; // Never released
+        remaining[i] = 0;
+        abs_deadline[i] = 0;
+        if (tasks[i].jitter_us > 0) continue;
+        hyperperiod = hyperperiod / gcd(hyperperiod, tasks[i].period_us) * tasks[i].period_us;
+        if (hyperperiod > MAX_HYPERPERIOD_MS * USEC_PER_MSEC) return -1;
+
+        release[i] = tasks[i].offset_us % tasks[i].period_us;
+        if (release[i] > max_phase) max_phase = release[i];
+    }
+
+    const long long horizon = max_phase + 2 * hyperperiod;
+    long long t = 0;
+
+    while (t < horizon) {
+        long long next_release = horizon;
+        for (int i = 0; i < count; i++) {
+            if (release[i] == t) {
+                // Constrained deadlines: a pending job at the next release has already missed
+                if (remaining[i] > 0) {
+                    set_miss(miss, &tasks[i], t - (abs_deadline[i] - tasks[i].deadline_us));
+                    return 0;
+                }
+                remaining[i] = charge[i];
+                abs_deadline[i] = t + tasks[i].deadline_us;
+                release[i] += tasks[i].period_us;
+            }
+            if (release[i] < next_release) next_release = release[i];
+        }
+
+        // Distinct priorities: the first pending entry in sorted order runs, equal deadlines included
+        int running = -1;
+        for (int i = 0; i < count; i++) {
+            if (remaining[i] > 0) {
+                running = i;
+                break;
+            }
+        }
+
+        if (running == -1) {
+            t = next_release;
+            continue;
+        }
+
+        const long long slice = (t + remaining[running] < next_release) ? remaining[running] : next_release - t;
+        remaining[running] -= slice;
+        t += slice;
+
+        if (remaining[running] == 0 && t > abs_deadline[running]) {
+            set_miss(miss, &tasks[running], t - (abs_deadline[running] - tasks[running].deadline_us));
+            return 0;
+        }
+    }
+
+    for (int i = 0; i < count; i++) {
+        if (remaining[i] > 0 && abs_deadline[i] < t) {
+            set_miss(miss, &tasks[i], t - (abs_deadline[i] - tasks[i].deadline_us));
+            return 0;
+        }
+    }
+    return 1;
+}
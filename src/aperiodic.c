@@ -0,0 +1,191 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include "constants.h"
+#include "aperiodic.h"
+#include "metrics.h"
+
+#define NSEC_PER_SEC 1000000000LL
+#define MSEC_PER_NSEC 1000000LL
+
+typedef struct {
+    const TaskType *type;
+    long long submitted_ns;
+} AperiodicJob;
+
+static pthread_t server_thread;
+static pthread_mutex_t queue_mutex = PTHREAD_MUTEX_INITIALIZER; // Priority inheritance once started
+static pthread_cond_t queue_cond;
+static AperiodicJob queue[APERIODIC_QUEUE_SIZE];
+static int queue_head;
+static int queue_count;
+static bool enabled;
+static bool running;
+static long next_job = 1;
+static long long budget_ns;
+static long long period_ns;
+static int server_priority; // Supervisor only
+static AperiodicStats stats;
+static double total_response_ms;
+
+static long long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long) ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+static long long cpu_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (long long) ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+static struct timespec to_timespec(const long long ns) {
+    const struct timespec ts = {.tv_sec = ns / NSEC_PER_SEC, .tv_nsec = ns % NSEC_PER_SEC};
+    return ts;
+}
+
+static void *server_entry(void *arg) {
+    (void) arg;
+    long long remaining = budget_ns;
+    long long replenish = now_ns() + period_ns;
+
+    pthread_mutex_lock(&queue_mutex);
+    while (running) {
+        // Deferrable server: the budget is refilled at period boundaries, whether used or not
+        const long long now = now_ns();
+        if (now >= replenish) {
+            remaining = budget_ns;
+            replenish += ((now - replenish) / period_ns + 1) * period_ns;
+        }
+
+        // A HI job is charged its C_HI: it is never abandoned at its C_LO here
+        const long long wcet_ns = queue_count > 0 ? task_wcet_ms(queue[queue_head].type, CRIT_HI) * MSEC_PER_NSEC : 0;
+        if (queue_count == 0 || remaining < wcet_ns) {
+            const struct timespec until = to_timespec(replenish);
+            pthread_cond_timedwait(&queue_cond, &queue_mutex, &until);
+            continue;
+        }
+
+        const AperiodicJob job = queue[queue_head];
+        queue_head = (queue_head + 1) % APERIODIC_QUEUE_SIZE;
+        queue_count--;
+        pthread_mutex_unlock(&queue_mutex);
+
+        const long long cpu_start = cpu_ns();
+        if (job.type->routine_fn) job.type->routine_fn(NULL); // Runs to completion: the budget was charged up front
+        const long long used = cpu_ns() - cpu_start;
+        const long long end = now_ns();
+
+        if (end >= replenish) {
+            // Preempted across a boundary: bill the new period for the whole job, the worst case
+            replenish += ((end - replenish) / period_ns + 1) * period_ns;
+            remaining = budget_ns - wcet_ns;
+        } else {
+            remaining -= used > wcet_ns ? used : wcet_ns;
+        }
+        if (remaining < 0) remaining = 0;
+
+        const double response_ms = (double) (end - job.submitted_ns) / MSEC_PER_NSEC;
+        metrics_inc(METRIC_APERIODIC_COMPLETED);
+        pthread_mutex_lock(&queue_mutex);
+        stats.completed++;
+        total_response_ms += response_ms;
+        if (response_ms > stats.max_response_ms) stats.max_response_ms = response_ms;
+    }
+    pthread_mutex_unlock(&queue_mutex);
+    return NULL;
+}
+
+int aperiodic_start(const long budget_ms, const long period_ms, const int cpu, const int priority) {
+    // Shared with the network and supervisor threads: inherit their priority while held
+    pthread_mutexattr_t mattr;
+    pthread_mutexattr_init(&mattr);
+    pthread_mutexattr_setprotocol(&mattr, PTHREAD_PRIO_INHERIT);
+    pthread_mutex_init(&queue_mutex, &mattr);
+    pthread_mutexattr_destroy(&mattr);
+
+    pthread_condattr_t cattr;
+    pthread_condattr_init(&cattr);
+    pthread_condattr_setclock(&cattr, CLOCK_MONOTONIC);
+    pthread_cond_init(&queue_cond, &cattr);
+    pthread_condattr_destroy(&cattr);
+
+    budget_ns = budget_ms * MSEC_PER_NSEC;
+    period_ns = period_ms * MSEC_PER_NSEC;
+    stats.budget_ms = budget_ms;
+    stats.period_ms = period_ms;
+    running = true;
+
+    pthread_attr_t attr;
+    const struct sched_param param = {.sched_priority = priority};
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(cpu, &cpus);
+    pthread_attr_init(&attr);
+    pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+    pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+    pthread_attr_setschedparam(&attr, &param);
+    pthread_attr_setaffinity_np(&attr, sizeof(cpus), &cpus);
+
+    const int err = pthread_create(&server_thread, &attr, server_entry, NULL);
+    pthread_attr_destroy(&attr);
+    if (err != 0) {
+        running = false;
+        fprintf(stderr, "[Aperiodic] Error creating server thread. Check sudo/permissions.\n");
+        return -1;
+    }
+    enabled = true;
+    server_priority = priority;
+    printf("[Aperiodic] Deferrable server started: budget %ld ms every %ld ms (priority %d)\n",
+           budget_ms, period_ms, param.sched_priority);
+    return 0;
+}
+
+void aperiodic_set_priority(const int priority) {
+    if (!enabled || priority == server_priority) return;
+    const struct sched_param param = {.sched_priority = priority};
+    pthread_setschedparam(server_thread, SCHED_FIFO, &param);
+    server_priority = priority;
+}
+
+bool aperiodic_enabled(void) {
+    return enabled;
+}
+
+long aperiodic_submit(const TaskType *type) {
+    pthread_mutex_lock(&queue_mutex);
+    if (queue_count == APERIODIC_QUEUE_SIZE) {
+        pthread_mutex_unlock(&queue_mutex);
+        return -1;
+    }
+    const long job = next_job++;
+    queue[(queue_head + queue_count) % APERIODIC_QUEUE_SIZE] =
+            (AperiodicJob){.type = type, .submitted_ns = now_ns()};
+    queue_count++;
+    stats.submitted++;
+    pthread_cond_signal(&queue_cond);
+    pthread_mutex_unlock(&queue_mutex);
+    return job;
+}
+
+void aperiodic_get_stats(AperiodicStats *out) {
+    pthread_mutex_lock(&queue_mutex);
+    *out = stats;
+    out->queued = queue_count;
+    out->avg_response_ms = stats.completed ? total_response_ms / (double) stats.completed : 0;
+    pthread_mutex_unlock(&queue_mutex);
+}
+
+void aperiodic_stop(void) {
+    if (!enabled) return;
+    pthread_mutex_lock(&queue_mutex);
+    running = false;
+    queue_count = 0;
+    pthread_cond_signal(&queue_cond);
+    pthread_mutex_unlock(&queue_mutex);
+    pthread_join(server_thread, NULL);
+    enabled = false;
+}
@@ -0,0 +1,183 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "checkpoint.h"
+
+#define CHECKPOINT_MAGIC "DPTSTATE"
+#define CHECKPOINT_VERSION 4
+
+typedef struct {
+    uint64_t seq; // 0 = never written
+    uint32_t crc; // CRC-32 of 'state'
+    uint32_t reserved;
+    CheckpointState state;
+} CheckpointSlot;
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t slot_size; // Catches a file written by a build with other limits
+    CheckpointSlot slots[2];
+} CheckpointFile;
+
+static CheckpointFile *file = NULL;
+static int fd = -1;
+static uint64_t last_seq = 0;
+
+static pthread_t flusher;
+static pthread_mutex_t flush_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t flush_cond = PTHREAD_COND_INITIALIZER;
+static bool dirty = false;
+static bool stopping = false;
+
+static uint32_t crc32(const void *data, const size_t len) {
+    const unsigned char *p = data;
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= p[i];
+        for (int b = 0; b < 8; b++) crc = (crc >> 1) ^ (0xEDB88320u & -(crc & 1u));
+    }
+    return ~crc;
+}
+
+static bool slot_valid(const CheckpointSlot *slot) {
+    return slot->seq != 0 &&
+           slot->state.count >= 0 && slot->state.count <= MAX_INSTANCES &&
+           slot->crc == crc32(&slot->state, sizeof(slot->state));
+}
+
+/*
+ * Waits for a save, lets the batching delay collect the ones that follow,
+ * then pays for a single msync.
+ */
+static void *flusher_entry(void *arg) {
+    (void) arg;
+    const struct timespec delay = {.tv_sec = 0, .tv_nsec = CHECKPOINT_FLUSH_MS * 1000000L};
+
+    pthread_mutex_lock(&flush_mutex);
+    while (!stopping) {
+        while (!dirty && !stopping) pthread_cond_wait(&flush_cond, &flush_mutex);
+        if (!dirty) break;
+        pthread_mutex_unlock(&flush_mutex);
+        nanosleep(&delay, NULL);
+        pthread_mutex_lock(&flush_mutex);
+        dirty = false;
+        pthread_mutex_unlock(&flush_mutex);
+        if (msync(file, sizeof(*file), MS_SYNC) != 0) perror("[Checkpoint] msync");
+        pthread_mutex_lock(&flush_mutex);
+    }
+    pthread_mutex_unlock(&flush_mutex);
+    return NULL;
+}
+
+int checkpoint_open(const char *path) {
+    struct stat st;
+
+    // Owner only: the file holds tenant token hashes. An existing file may predate that.
+    fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (fd < 0 || fchmod(fd, 0600) != 0 || fstat(fd, &st) != 0) {
+        perror("[Checkpoint] open");
+        if (fd >= 0) close(fd);
+        fd = -1;
+        return -1;
+    }
+    const bool sized = st.st_size == (off_t) sizeof(CheckpointFile);
+    if (!sized && ftruncate(fd, sizeof(CheckpointFile)) != 0) {
+        perror("[Checkpoint] ftruncate");
+        close(fd);
+        fd = -1;
+        return -1;
+    }
+    file = mmap(NULL, sizeof(CheckpointFile), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (file == MAP_FAILED) {
+        perror("[Checkpoint] mmap");
+        file = NULL;
+        close(fd);
+        fd = -1;
+        return -1;
+    }
+
+    if (!sized || memcmp(file->magic, CHECKPOINT_MAGIC, sizeof(file->magic)) != 0 ||
+        file->version != CHECKPOINT_VERSION || file->slot_size != sizeof(CheckpointSlot)) {
+        if (st.st_size != 0) printf("[Checkpoint] %s is not a compatible state file, starting empty\n", path);
+        memset(file, 0, sizeof(*file));
+        memcpy(file->magic, CHECKPOINT_MAGIC, sizeof(file->magic));
+        file->version = CHECKPOINT_VERSION;
+        file->slot_size = sizeof(CheckpointSlot);
+        msync(file, sizeof(*file), MS_SYNC);
+    }
+    for (int i = 0; i < 2; i++) {
+        if (slot_valid(&file->slots[i]) && file->slots[i].seq > last_seq) last_seq = file->slots[i].seq;
+    }
+
+    stopping = false;
+    if (pthread_create(&flusher, NULL, flusher_entry, NULL) != 0) {
+        fprintf(stderr, "[Checkpoint] Failed to start the flusher\n");
+        munmap(file, sizeof(*file));
+        file = NULL;
+        close(fd);
+        fd = -1;
+        return -1;
+    }
+    printf("[Checkpoint] State file %s\n", path);
+    return 0;
+}
+
+bool checkpoint_enabled(void) {
+    return file != NULL;
+}
+
+int checkpoint_load(CheckpointState *out) {
+    const CheckpointSlot *best = NULL;
+
+    if (!file) return -1;
+    for (int i = 0; i < 2; i++) {
+        const CheckpointSlot *slot = &file->slots[i];
+        if (slot_valid(slot) && (!best || slot->seq > best->seq)) best = slot;
+    }
+    if (!best) return -1;
+    *out = best->state;
+    return 0;
+}
+
+void checkpoint_save(const CheckpointState *state) {
+    if (!file) return;
+
+    // Overwrite the older slot; the newer one stays intact until this one is complete
+    CheckpointSlot *slot = &file->slots[(last_seq + 1) % 2];
+    slot->seq = 0;
+    atomic_thread_fence(memory_order_release);
+    slot->state = *state;
+    slot->crc = crc32(&slot->state, sizeof(slot->state));
+    atomic_thread_fence(memory_order_release);
+    slot->seq = ++last_seq;
+
+    pthread_mutex_lock(&flush_mutex);
+    dirty = true;
+    pthread_cond_signal(&flush_cond);
+    pthread_mutex_unlock(&flush_mutex);
+}
+
+void checkpoint_close(void) {
+    if (!file) return;
+
+    pthread_mutex_lock(&flush_mutex);
+    stopping = true;
+    pthread_cond_signal(&flush_cond);
+    pthread_mutex_unlock(&flush_mutex);
+    pthread_join(flusher, NULL);
+
+    if (msync(file, sizeof(*file), MS_SYNC) != 0) perror("[Checkpoint] msync");
+    munmap(file, sizeof(*file));
+    close(fd);
+    file = NULL;
+    fd = -1;
+}
@@ -0,0 +1,167 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "constants.h"
+#include "cyclic.h"
+
+typedef struct {
+    int ref;
+    long wcet_ms;
+    long release_ms;
+    long deadline_ms;
+    int frame;      // Unrolled frame index, >= frame_count when wrapped into the next cycle
+    long start_ms;  // Unrolled start
+} CyclicJob;
+
+static long gcd(long a, long b) {
+    while (b != 0) {
+        const long t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+static int compare_deadline(const void *a, const void *b) {
+    const CyclicJob *x = a;
+    const CyclicJob *y = b;
+    if (x->deadline_ms != y->deadline_ms) return (x->deadline_ms > y->deadline_ms) ? 1 : -1;
+    return (x->release_ms > y->release_ms) - (x->release_ms < y->release_ms);
+}
+
+static int compare_start(const void *a, const void *b) {
+    const CyclicEntry *x = a;
+    const CyclicEntry *y = b;
+    return (x->start_ms > y->start_ms) - (x->start_ms < y->start_ms);
+}
+
+/*
+ * Time from the frame start until 'work_ms' of jobs completes, in microseconds,
+ * or -1 if it does not fit in the frame.
+ */
+static long long frame_finish_us(const CyclicInterference *intf, const long work_ms, const long frame) {
+    const long long work_us = work_ms * 1000LL;
+    if (!intf) return work_ms <= frame ? work_us : -1;
+    return analysis_busy_time(intf->threads, intf->count, work_us + intf->frame_overhead_us, frame * 1000LL);
+}
+
+/*
+ * Places every job, in deadline order, into the earliest frame that starts
+ * after its release and has room to finish it by its deadline.
+ * Frames past the hyperperiod wrap onto the start of the next cycle.
+ */
+static int pack(CyclicJob *jobs, const int job_count, const long hyperperiod, const long frame, long *used,
+                const CyclicInterference *intf) {
+    const int frames = (int) (hyperperiod / frame);
+    for (int i = 0; i < frames; i++) used[i] = 0;
+
+    for (int i = 0; i < job_count; i++) {
+        CyclicJob *job = &jobs[i];
+        const int first = (int) ((job->release_ms + frame - 1) / frame);
+        job->frame = -1;
+        for (int k = first; k < first + frames; k++) {
+            const int slot = k % frames;
+            const long start = (long) k * frame + used[slot];
+            const long long finish_us = frame_finish_us(intf, used[slot] + job->wcet_ms, frame);
+            if (finish_us < 0) continue;
+            if ((long long) k * frame * 1000LL + finish_us > job->deadline_ms * 1000LL) break; // Later frames only finish later
+            job->frame = k;
+            job->start_ms = start;
+            used[slot] += job->wcet_ms;
+            break;
+        }
+        if (job->frame < 0) return 0;
+    }
+    return 1;
+}
+
+CyclicTable *cyclic_build(const Task *set, const int count, const CyclicInterference *intf) {
+    long hyperperiod = 1;
+    long max_wcet = 0;
+    int job_count = 0;
+
+    if (count == 0) return calloc(1, sizeof(CyclicTable)); // Idle table
+    for (int i = 0; i < count; i++) {
+        hyperperiod = hyperperiod / gcd(hyperperiod, set[i].period_ms) * set[i].period_ms;
+        if (hyperperiod > MAX_HYPERPERIOD_MS) {
+            printf("[Cyclic] Hyperperiod exceeds %d ms\n", MAX_HYPERPERIOD_MS);
+            return NULL;
+        }
+        if (task_wcet_ms(set[i].type, CRIT_HI) > max_wcet) max_wcet = task_wcet_ms(set[i].type, CRIT_HI);
+    }
+    for (int i = 0; i < count; i++) job_count += (int) (hyperperiod / set[i].period_ms);
+
+    CyclicJob *jobs = malloc(sizeof(CyclicJob) * job_count);
+    long *used = malloc(sizeof(long) * CYCLIC_MAX_FRAMES);
+    if (!jobs || !used) {
+        free(jobs);
+        free(used);
+        return NULL;
+    }
+
+    int n = 0;
+    for (int i = 0; i < count; i++) {
+        for (long r = set[i].offset_ms % set[i].period_ms; r < hyperperiod; r += set[i].period_ms) {
+            jobs[n++] = (CyclicJob){
+                .ref = i, .wcet_ms = task_wcet_ms(set[i].type, CRIT_HI), .release_ms = r,
+                .deadline_ms = r + set[i].type->deadline_ms
+            };
+        }
+    }
+    qsort(jobs, job_count, sizeof(CyclicJob), compare_deadline);
+
+    // Largest feasible frame first: fewer wakeups per hyperperiod
+    long frame = 0;
+    for (long f = hyperperiod; f >= max_wcet && f > 0; f--) {
+        if (hyperperiod % f != 0 || hyperperiod / f > CYCLIC_MAX_FRAMES) continue;
+        if (pack(jobs, job_count, hyperperiod, f, used, intf)) {
+            frame = f;
+            break;
+        }
+    }
+    free(used);
+    if (frame == 0) {
+        printf("[Cyclic] No frame size fits the set (H=%ld ms)\n", hyperperiod);
+        free(jobs);
+        return NULL;
+    }
+
+    CyclicTable *table = calloc(1, sizeof(CyclicTable));
+    const int frames = (int) (hyperperiod / frame);
+    if (table) {
+        table->entries = malloc(sizeof(CyclicEntry) * job_count);
+        table->frame_first = calloc(frames + 1, sizeof(int));
+    }
+    if (!table || !table->entries || !table->frame_first) {
+        cyclic_free(table);
+        free(jobs);
+        return NULL;
+    }
+    table->hyperperiod_ms = hyperperiod;
+    table->frame_ms = frame;
+    table->frame_count = frames;
+    table->entry_count = job_count;
+
+    for (int i = 0; i < job_count; i++) {
+        // Re-base wrapped jobs onto the cycle they execute in
+        const long shift = (jobs[i].frame / frames) * hyperperiod;
+        table->entries[i] = (CyclicEntry){
+            .ref = jobs[i].ref, .instance_id = set[jobs[i].ref].instance_id,
+            .start_ms = jobs[i].start_ms - shift, .release_ms = jobs[i].release_ms - shift,
+            .deadline_ms = jobs[i].deadline_ms - shift
+        };
+    }
+    free(jobs);
+    qsort(table->entries, job_count, sizeof(CyclicEntry), compare_start);
+
+    for (int i = 0; i < job_count; i++) table->frame_first[table->entries[i].start_ms / frame + 1]++;
+    for (int f = 0; f < frames; f++) table->frame_first[f + 1] += table->frame_first[f];
+
+    return table;
+}
+
+void cyclic_free(CyclicTable *table) {
+    if (!table) return;
+    free(table->frame_first);
+    free(table->entries);
+    free(table);
+}
@@ -4,21 +4,52 @@
 #include <strings.h>
 #include "event.h"
 
+/* Whole-string decimal conversion. */
+static int parse_long(const char *text, long *out) {
+    char *end;
+    *out = strtol(text, &end, 10);
+    return end != text && *end == '\0' ? 0 : -1;
+}
+
+/* A file name that cannot leave the directory it is opened in. */
+static int valid_file_name(const char *name) {
+    return name[0] != '\0' && strchr(name, '/') == NULL && strcmp(name, ".") != 0 && strcmp(name, "..") != 0;
+}
+
 int event_parse(const char *line, const int client_fd, Event *out_event) {
     char cmd[32] = {0};
     char arg[32] = {0};
+    char arg2[TRACE_PATH_LEN] = {0};
 
+    out_event->channel = REPLY_TCP;
     out_event->client_fd = client_fd;
     out_event->type = EV_UNKNOWN;
     memset(&out_event->payload, 0, sizeof(out_event->payload));
+    memset(out_event->tenant, 0, sizeof(out_event->tenant));
+    memset(out_event->token, 0, sizeof(out_event->token));
+    out_event->admin = false;
 
-    const int tokens = sscanf(line, "%31s %31s", cmd, arg);
+    const int tokens = sscanf(line, "%31s %31s %63s", cmd, arg, arg2);
     if (tokens < 1) return -1;
 
     if (strcasecmp(cmd, "ACTIVATE") == 0) {
         if (tokens < 2) return -1;
+        long offset = 0;
+        if (tokens >= 3) {
+            char *end;
+            offset = strtol(arg2, &end, 10);
+            if (*end != '\0' || offset < 0) return -1;
+        }
         out_event->type = EV_ACTIVATE;
-        strncpy(out_event->payload.task_name, arg, TASK_NAME_LEN - 1);
+        strncpy(out_event->payload.activate.task_name, arg, TASK_NAME_LEN - 1);
+        out_event->payload.activate.offset_ms = offset;
+        return 0;
+    }
+
+    if (strcasecmp(cmd, "SUBMIT") == 0) {
+        if (tokens < 2) return -1;
+        out_event->type = EV_SUBMIT;
+        strncpy(out_event->payload.submit.task_name, arg, TASK_NAME_LEN - 1);
         return 0;
     }
 
@@ -33,6 +64,15 @@ int event_parse(const char *line, const int client_fd, Event *out_event) {
     }
 
     if (strcasecmp(cmd, "LIST") == 0) {
+        char *end;
+        if (tokens >= 2) {
+            out_event->payload.list.offset = strtol(arg, &end, 10);
+            if (*end != '\0' || out_event->payload.list.offset < 0) return -1;
+        }
+        if (tokens >= 3) {
+            out_event->payload.list.limit = strtol(arg2, &end, 10);
+            if (*end != '\0' || out_event->payload.list.limit < 0) return -1;
+        }
         out_event->type = EV_LIST;
         return 0;
     }
@@ -42,6 +82,66 @@ int event_parse(const char *line, const int client_fd, Event *out_event) {
         return 0;
     }
 
+    if (strcasecmp(cmd, "METRICS") == 0) {
+        out_event->type = EV_METRICS;
+        return 0;
+    }
+
+    if (strcasecmp(cmd, "TRACE") == 0) {
+        if (tokens < 2) return -1;
+        if (strcasecmp(arg, "START") == 0) out_event->payload.trace.action = TRACE_ACTION_START;
+        else if (strcasecmp(arg, "STOP") == 0) out_event->payload.trace.action = TRACE_ACTION_STOP;
+        else if (strcasecmp(arg, "DUMP") == 0) out_event->payload.trace.action = TRACE_ACTION_DUMP;
+        else return -1;
+        strncpy(out_event->payload.trace.file, tokens >= 3 ? arg2 : "trace.bin", TRACE_PATH_LEN - 1);
+        if (!valid_file_name(out_event->payload.trace.file)) return -1;
+        out_event->type = EV_TRACE;
+        return 0;
+    }
+
+    if (strcasecmp(cmd, "RESERVE") == 0) {
+        char num[3][32] = {{0}};
+        char extra;
+        long budget, period, max = MAX_INSTANCES;
+        const int n = sscanf(line, "%*s %31s %31s %31s %31s %c", arg, num[0], num[1], num[2], &extra);
+        if (n < 3 || n > 4 || parse_long(num[0], &budget) != 0 || parse_long(num[1], &period) != 0 ||
+            (n == 4 && parse_long(num[2], &max) != 0)) return -1;
+        if (budget <= 0 || budget > period || max <= 0 || max > MAX_INSTANCES) return -1;
+        out_event->type = EV_RESERVE;
+        strncpy(out_event->payload.reserve.name, arg, TASK_NAME_LEN - 1);
+        out_event->payload.reserve.budget_ms = budget;
+        out_event->payload.reserve.period_ms = period;
+        out_event->payload.reserve.max_instances = (int) max;
+        return 0;
+    }
+
+    if (strcasecmp(cmd, "UNRESERVE") == 0) {
+        if (tokens < 2) return -1;
+        out_event->type = EV_UNRESERVE;
+        strncpy(out_event->payload.unreserve.name, arg, TASK_NAME_LEN - 1);
+        return 0;
+    }
+
+    if (strcasecmp(cmd, "TENANT") == 0) {
+        char token[ACCESS_TOKEN_LEN + 1] = {0};
+        char extra;
+        // The token may be longer than the generic argument buffers
+        if (sscanf(line, "%*s %31s %33s %c", arg, token, &extra) != 2 || strlen(token) >= ACCESS_TOKEN_LEN) return -1;
+        out_event->type = EV_TENANT;
+        strncpy(out_event->payload.tenant.name, arg, TASK_NAME_LEN - 1);
+        memcpy(out_event->payload.tenant.token, token, ACCESS_TOKEN_LEN);
+        return 0;
+    }
+
+    if (strcasecmp(cmd, "ADMIN") == 0) {
+        char token[ACCESS_TOKEN_LEN + 1] = {0};
+        char extra;
+        if (sscanf(line, "%*s %33s %c", token, &extra) != 1 || strlen(token) >= ACCESS_TOKEN_LEN) return -1;
+        out_event->type = EV_ADMIN;
+        memcpy(out_event->payload.admin.token, token, ACCESS_TOKEN_LEN);
+        return 0;
+    }
+
     if (strcasecmp(cmd, "SHUTDOWN") == 0) {
         out_event->type = EV_SHUTDOWN;
         return 0;
@@ -49,3 +149,64 @@ int event_parse(const char *line, const int client_fd, Event *out_event) {
 
     return -1;
 }
+
+int event_validate(Event *ev) {
+    ev->tenant[TASK_NAME_LEN - 1] = '\0';
+    ev->token[ACCESS_TOKEN_LEN - 1] = '\0';
+    switch (ev->type) {
+        case EV_ACTIVATE:
+            ev->payload.activate.task_name[TASK_NAME_LEN - 1] = '\0';
+            return ev->payload.activate.offset_ms >= 0 ? 0 : -1;
+        case EV_SUBMIT:
+            ev->payload.submit.task_name[TASK_NAME_LEN - 1] = '\0';
+            return 0;
+        case EV_LIST:
+            return ev->payload.list.offset >= 0 && ev->payload.list.limit >= 0 ? 0 : -1;
+        case EV_TRACE:
+            ev->payload.trace.file[TRACE_PATH_LEN - 1] = '\0';
+            return ev->payload.trace.action >= TRACE_ACTION_START && ev->payload.trace.action <= TRACE_ACTION_DUMP &&
+                   valid_file_name(ev->payload.trace.file) ? 0 : -1;
+        case EV_RESERVE:
+            ev->payload.reserve.name[TASK_NAME_LEN - 1] = '\0';
+            return ev->payload.reserve.name[0] != '\0' && ev->payload.reserve.budget_ms > 0 &&
+                   ev->payload.reserve.budget_ms <= ev->payload.reserve.period_ms &&
+                   ev->payload.reserve.max_instances > 0 && ev->payload.reserve.max_instances <= MAX_INSTANCES
+                       ? 0 : -1;
+        case EV_UNRESERVE:
+            ev->payload.unreserve.name[TASK_NAME_LEN - 1] = '\0';
+            return ev->payload.unreserve.name[0] != '\0' ? 0 : -1;
+        case EV_DEACTIVATE:
+        case EV_INFO:
+        case EV_METRICS:
+        case EV_SHUTDOWN:
+            return 0;
+        default:
+            return -1;
+    }
+}
+
+bool event_token_equal(const char *expected, const char *given) {
+    unsigned char diff = 0;
+    for (int i = 0; i < ACCESS_TOKEN_LEN; i++) diff |= (unsigned char) (expected[i] ^ given[i]);
+    return expected[0] != '\0' && diff == 0;
+}
+
+const char *event_status_text(const EventStatus status) {
+    static const char *texts[STATUS_COUNT] = {
+        [STATUS_OK] = "OK",
+        [STATUS_ERR_INVALID_COMMAND] = "ERR Invalid Command",
+        [STATUS_ERR_UNKNOWN_TASK] = "ERR Unknown Task",
+        [STATUS_ERR_SCHEDULABILITY] = "ERR Schedulability",
+        [STATUS_ERR_SYSTEM_FULL] = "ERR System Full",
+        [STATUS_ERR_INVALID_ID] = "ERR Invalid ID",
+        [STATUS_ERR_SYSTEM_BUSY] = "ERR System Busy",
+        [STATUS_ERR_NO_APERIODIC_SERVER] = "ERR No Aperiodic Server",
+        [STATUS_ERR_EXCEEDS_SERVER_BUDGET] = "ERR Exceeds Server Budget",
+        [STATUS_ERR_SERVER_QUEUE_FULL] = "ERR Server Queue Full",
+        [STATUS_ERR_TRACE_DUMP] = "ERR Trace Dump Failed",
+        [STATUS_ERR_UNKNOWN_RESERVATION] = "ERR Unknown Reservation",
+        [STATUS_ERR_RESERVATION_IN_USE] = "ERR Reservation In Use",
+        [STATUS_ERR_PERMISSION_DENIED] = "ERR Permission Denied"
+    };
+    return status >= 0 && status < STATUS_COUNT ? texts[status] : "ERR Unknown Status";
+}
@@ -1,6 +1,7 @@
 #include <pthread.h>
 
 #include "event_queue.h"
+#include "metrics.h"
 
 int event_queue_push(EventQueue* queue, const Event ev) {
     int has_pushed = -1;
@@ -9,6 +10,8 @@ int event_queue_push(EventQueue* queue, const Event ev) {
         queue->buffer[queue->tail] = ev;
         queue->tail = (queue->tail + 1) % MAX_QUEUE_SIZE;
         queue->count++;
+        metrics_gauge_set(GAUGE_QUEUE_DEPTH, queue->count);
+        metrics_gauge_max(GAUGE_QUEUE_HIGH_WATER, queue->count);
         pthread_cond_signal(&queue->cond);
         has_pushed = 0;
     }
@@ -24,6 +27,7 @@ Event event_queue_pop(EventQueue* queue) {
     const Event ev = queue->buffer[queue->head];
     queue->head = (queue->head + 1) % MAX_QUEUE_SIZE;
     queue->count--;
+    metrics_gauge_set(GAUGE_QUEUE_DEPTH, queue->count);
     pthread_mutex_unlock(&queue->mutex);
     return ev;
 }
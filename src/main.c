@@ -6,11 +6,23 @@
 #include <sched.h>
 #include <stdatomic.h>
 #include <signal.h>
+#include <getopt.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
 #include "supervisor.h"
 #include "tcp_server.h"
 #include "constants.h"
 #include "task_runtime.h"
 #include "task_config.h"
+#include "topology.h"
+#include "metrics.h"
+#include "profiler.h"
+#include "aperiodic.h"
+#include "overhead.h"
+#include "checkpoint.h"
+#include "shm_server.h"
+#include "trace.h"
 
 // Context to pass multiple arguments to the network thread
 typedef struct {
@@ -18,6 +30,24 @@ typedef struct {
     TcpServer *server;
 } NetworkContext;
 
+// Settings collected from the command line
+typedef struct {
+    Topology topo;
+    int metrics_port;
+    AdmissionMode admission_mode;
+    double wcet_margin;
+    const char *record_path;
+    long server_budget_ms;
+    long server_period_ms;
+    RuntimeMode mode;
+    int command_budget;
+    int event_budget;
+    const char *state_path;
+    const char *shm_name;
+    const char *trace_dir;
+    const char *admin_token;
+} Options;
+
 // Empty handler to interrupt blocking syscalls (e.g., nanosleep)
 static void sigusr1_handler(const int signum) { (void) signum; }
 
@@ -37,6 +67,14 @@ static void *network_entry(void *arg) {
     return NULL;
 }
 
+static void *shm_entry(void *arg) {
+    Supervisor *sv = arg;
+    while (atomic_load(&sv->running)) {
+        shm_server_poll(sv);
+    }
+    return NULL;
+}
+
 static void *supervisor_entry(void *arg) {
     Supervisor *sv = arg;
     supervisor_loop(sv);
@@ -44,34 +82,245 @@ static void *supervisor_entry(void *arg) {
     return NULL;
 }
 
-static void set_fifo_priority(pthread_attr_t *attr, const int prio) {
+static void set_fifo_priority(pthread_attr_t *attr, const int prio, const cpu_set_t *cpus) {
     const struct sched_param param = {.sched_priority = prio};
     pthread_attr_init(attr);
     pthread_attr_setinheritsched(attr, PTHREAD_EXPLICIT_SCHED);
     pthread_attr_setschedpolicy(attr, SCHED_FIFO);
     pthread_attr_setschedparam(attr, &param);
+    pthread_attr_setaffinity_np(attr, sizeof(cpu_set_t), cpus);
+}
+
+static void usage(const char *prog) {
+    printf("Usage: %s [--topology FILE] [--task-cpu N] [--control-cpus LIST] [--metrics-port PORT]\n"
+           "       [--admission declared|measured] [--wcet-margin FACTOR] [--record-commands FILE]\n"
+           "       [--server-budget MS --server-period MS] [--mode threads|cyclic]\n"
+           "       [--command-budget N] [--event-budget N] [--state-file FILE]\n"
+           "       [--shm-channel NAME] [--trace-dir DIR] [--admin-token TOKEN]\n", prog);
+}
+
+/*
+ * Whole-string decimal option value within [min, max].
+ * Returns 0 on success, -1 with a message and the usage otherwise.
+ */
+static int parse_long_arg(const char *prog, const char *name, const char *text, const long min, const long max,
+                          long *out) {
+    char *end;
+    errno = 0;
+    const long value = strtol(text, &end, 10);
+    if (end == text || *end != '\0' || errno != 0 || value < min || value > max) {
+        fprintf(stderr, "[Main] Invalid --%s '%s': expected an integer in [%ld, %ld]\n", name, text, min, max);
+        usage(prog);
+        return -1;
+    }
+    *out = value;
+    return 0;
+}
+
+// Defaults, then the topology file, then command line overrides
+static int parse_args(const int argc, char **argv, Options *opts) {
+    enum { OPT_TOPOLOGY = 1, OPT_TASK_CPU, OPT_CONTROL_CPUS, OPT_METRICS_PORT, OPT_ADMISSION, OPT_WCET_MARGIN,
+        OPT_RECORD_COMMANDS, OPT_SERVER_BUDGET, OPT_SERVER_PERIOD, OPT_MODE, OPT_COMMAND_BUDGET, OPT_EVENT_BUDGET,
+        OPT_STATE_FILE, OPT_SHM_CHANNEL, OPT_TRACE_DIR, OPT_ADMIN_TOKEN
+    };
+    static const struct option options[] = {
+        {"topology", required_argument, NULL, OPT_TOPOLOGY},
+        {"task-cpu", required_argument, NULL, OPT_TASK_CPU},
+        {"control-cpus", required_argument, NULL, OPT_CONTROL_CPUS},
+        {"metrics-port", required_argument, NULL, OPT_METRICS_PORT},
+        {"admission", required_argument, NULL, OPT_ADMISSION},
+        {"wcet-margin", required_argument, NULL, OPT_WCET_MARGIN},
+        {"record-commands", required_argument, NULL, OPT_RECORD_COMMANDS},
+        {"server-budget", required_argument, NULL, OPT_SERVER_BUDGET},
+        {"server-period", required_argument, NULL, OPT_SERVER_PERIOD},
+        {"mode", required_argument, NULL, OPT_MODE},
+        {"command-budget", required_argument, NULL, OPT_COMMAND_BUDGET},
+        {"event-budget", required_argument, NULL, OPT_EVENT_BUDGET},
+        {"state-file", required_argument, NULL, OPT_STATE_FILE},
+        {"shm-channel", required_argument, NULL, OPT_SHM_CHANNEL},
+        {"trace-dir", required_argument, NULL, OPT_TRACE_DIR},
+        {"admin-token", required_argument, NULL, OPT_ADMIN_TOKEN},
+        {"help", no_argument, NULL, 'h'},
+        {NULL, 0, NULL, 0}
+    };
+
+    const char *topology_file = NULL;
+    const char *task_cpu = NULL;
+    const char *control_cpus = NULL;
+    long value;
+    int opt;
+    while ((opt = getopt_long(argc, argv, "h", options, NULL)) != -1) {
+        switch (opt) {
+            case OPT_TOPOLOGY: topology_file = optarg;
+                break;
+            case OPT_TASK_CPU: task_cpu = optarg;
+                break;
+            case OPT_CONTROL_CPUS: control_cpus = optarg;
+                break;
+            case OPT_METRICS_PORT:
+                if (parse_long_arg(argv[0], "metrics-port", optarg, 1, 65535, &value) != 0) return -1;
+                opts->metrics_port = (int) value;
+                break;
+            case OPT_ADMISSION:
+                if (strcmp(optarg, "measured") == 0) opts->admission_mode = ADMISSION_MEASURED;
+                else if (strcmp(optarg, "declared") == 0) opts->admission_mode = ADMISSION_DECLARED;
+                else {
+                    fprintf(stderr, "[Main] Unknown admission mode '%s'\n", optarg);
+                    return -1;
+                }
+                break;
+            case OPT_WCET_MARGIN: {
+                char *end;
+                errno = 0;
+                opts->wcet_margin = strtod(optarg, &end);
+                // Also rejects NaN, which compares false
+                if (end == optarg || *end != '\0' || errno != 0 || !(opts->wcet_margin >= 1.0) ||
+                    opts->wcet_margin > 1e6) {
+                    fprintf(stderr, "[Main] Invalid --wcet-margin '%s': expected a number >= 1.0\n", optarg);
+                    usage(argv[0]);
+                    return -1;
+                }
+                break;
+            }
+            case OPT_RECORD_COMMANDS: opts->record_path = optarg;
+                break;
+            case OPT_SERVER_BUDGET:
+                if (parse_long_arg(argv[0], "server-budget", optarg, 1, MAX_HYPERPERIOD_MS, &value) != 0) return -1;
+                opts->server_budget_ms = value;
+                break;
+            case OPT_SERVER_PERIOD:
+                if (parse_long_arg(argv[0], "server-period", optarg, 1, MAX_HYPERPERIOD_MS, &value) != 0) return -1;
+                opts->server_period_ms = value;
+                break;
+            case OPT_MODE:
+                if (strcmp(optarg, "cyclic") == 0) opts->mode = RUNTIME_CYCLIC;
+                else if (strcmp(optarg, "threads") == 0) opts->mode = RUNTIME_THREADS;
+                else {
+                    fprintf(stderr, "[Main] Unknown runtime mode '%s'\n", optarg);
+                    return -1;
+                }
+                break;
+            // 0 would mean unlimited to control_window_take() while admission still charges a budget
+            case OPT_COMMAND_BUDGET:
+                if (parse_long_arg(argv[0], "command-budget", optarg, 1, INT_MAX, &value) != 0) return -1;
+                opts->command_budget = (int) value;
+                break;
+            case OPT_EVENT_BUDGET:
+                if (parse_long_arg(argv[0], "event-budget", optarg, 1, INT_MAX, &value) != 0) return -1;
+                opts->event_budget = (int) value;
+                break;
+            case OPT_STATE_FILE: opts->state_path = optarg;
+                break;
+            case OPT_SHM_CHANNEL: opts->shm_name = optarg;
+                break;
+            case OPT_TRACE_DIR: opts->trace_dir = optarg;
+                break;
+            case OPT_ADMIN_TOKEN: opts->admin_token = optarg;
+                break;
+            default: usage(argv[0]);
+                return -1;
+        }
+    }
+
+    if ((opts->server_budget_ms > 0) != (opts->server_period_ms > 0) ||
+        opts->server_budget_ms < 0 || opts->server_budget_ms > opts->server_period_ms) {
+        fprintf(stderr, "[Main] The aperiodic server needs 0 < --server-budget <= --server-period\n");
+        return -1;
+    }
+    if (opts->admin_token && (opts->admin_token[0] == '\0' || strlen(opts->admin_token) >= ACCESS_TOKEN_LEN)) {
+        fprintf(stderr, "[Main] The admin token must be 1 to %d characters\n", ACCESS_TOKEN_LEN - 1);
+        return -1;
+    }
+    if (opts->mode == RUNTIME_CYCLIC && opts->server_budget_ms > 0) {
+        fprintf(stderr, "[Main] The aperiodic server is not available in cyclic mode\n");
+        return -1;
+    }
+
+    Topology *topo = &opts->topo;
+    topology_init(topo);
+    if (topology_file && topology_load_file(topo, topology_file) != 0) return -1;
+    // Command line over the file; topology_resolve() rejects CPUs that are not online
+    if (task_cpu && topology_parse_cpu(task_cpu, &topo->task_cpu) != 0) {
+        fprintf(stderr, "[Main] Invalid task CPU '%s'\n", task_cpu);
+        return -1;
+    }
+    if (control_cpus) {
+        if (topology_parse_cpulist(control_cpus, &topo->control_cpus) != 0) {
+            fprintf(stderr, "[Main] Invalid CPU list '%s'\n", control_cpus);
+            return -1;
+        }
+        topo->control_set = true;
+    }
+    return topology_resolve(topo);
 }
 
-int main(void) {
+int main(const int argc, char **argv) {
     setvbuf(stdout, NULL, _IONBF, 0); // Disable buffering for real-time logs
     setup_signals();
 
+    Options opts = {
+        .metrics_port = 0,
+        .admission_mode = ADMISSION_DECLARED,
+        .wcet_margin = PROFILE_DEFAULT_MARGIN,
+        .command_budget = CONTROL_COMMAND_BUDGET,
+        .event_budget = CONTROL_EVENT_BUDGET
+    };
+    if (parse_args(argc, argv, &opts) != 0) {
+        return EXIT_FAILURE;
+    }
+    const Topology topo = opts.topo;
+    topology_report(&topo);
+
     if (geteuid() != 0) {
         fprintf(stderr, "WARNING: Not running as root. SCHED_FIFO tasks may fail.\n");
     }
 
+    // Calibrate on the core the tasks will run on
     cpu_set_t cpuset;
     CPU_ZERO(&cpuset);
-    CPU_SET(CPU_NUMBER, &cpuset);
+    CPU_SET(topo.task_cpu, &cpuset);
     if (sched_setaffinity(0, sizeof(cpuset), &cpuset) != 0) {
         perror("[Main] Failed to set CPU affinity");
     }
 
     /* Initialize ALL internal subsystems before creating threads or opening sockets. */
+    metrics_init(topo.task_cpu);
     Supervisor supervisor;
     supervisor_init(&supervisor);
+    supervisor.admission.mode = opts.admission_mode;
+    supervisor.admission.wcet_margin = opts.wcet_margin;
+    supervisor.admission.server_budget_ms = opts.server_budget_ms;
+    supervisor.admission.server_period_ms = opts.server_period_ms;
+    supervisor.admission.cyclic = opts.mode == RUNTIME_CYCLIC;
+    supervisor.admission.command_budget = opts.command_budget;
+    supervisor.admission.event_budget = opts.event_budget;
+    supervisor.admission.control_on_task_cpu = topology_control_shares_task_cpu(&topo);
+    if (opts.trace_dir) trace_set_dir(opts.trace_dir);
     tasks_config_init(&tasks_config); // Blocking CPU calibration
-    runtime_init();
+    overhead_calibrate(topo.task_cpu, &supervisor.admission.overhead);
+    profiler_init(&tasks_config);
+    if (runtime_init(topo.task_cpu, opts.mode, &supervisor.admission) != 0) {
+        return EXIT_FAILURE;
+    }
+    if (opts.server_budget_ms > 0 &&
+        aperiodic_start(opts.server_budget_ms, opts.server_period_ms, topo.task_cpu,
+                        admission_priorities(&supervisor.admission, NULL, 0, NULL)) != 0) {
+        return EXIT_FAILURE;
+    }
+
+    // Everything but the task threads stays on the housekeeping cores
+    if (sched_setaffinity(0, sizeof(cpu_set_t), &topo.control_cpus) != 0) {
+        perror("[Main] Failed to set control-plane CPU affinity");
+    }
+
+    // Warm restart: re-admit the saved set before commands can change it
+    if (opts.state_path) {
+        CheckpointState state;
+        if (checkpoint_open(opts.state_path) != 0) {
+            return EXIT_FAILURE;
+        }
+        if (checkpoint_load(&state) == 0) supervisor_restore(&supervisor, &state);
+    }
 
     // Open network port only after internals are ready
     TcpServer server;
@@ -79,13 +328,24 @@ int main(void) {
     if (net_err != 0) {
         return EXIT_FAILURE;
     }
+    if (opts.record_path && tcp_server_record_commands(opts.record_path) != 0) {
+        return EXIT_FAILURE;
+    }
+    if (opts.admin_token) tcp_server_set_admin_token(opts.admin_token);
+    if (opts.shm_name && shm_server_init(opts.shm_name) != 0) {
+        return EXIT_FAILURE;
+    }
+
+    if (opts.metrics_port > 0 && metrics_http_start(opts.metrics_port) != 0) {
+        fprintf(stderr, "[Main] Metrics endpoint disabled\n");
+    }
 
-    pthread_t net_thread, sv_thread;
+    pthread_t net_thread, sv_thread, shm_thread;
     pthread_attr_t net_attr, sv_attr;
 
-    // Priorities: Network (99) > Supervisor (98) > Tasks (max 90)
-    set_fifo_priority(&net_attr, 99);
-    set_fifo_priority(&sv_attr, 98);
+    // Priorities: Network and shared-memory channel (99) > Supervisor (98) > Tasks (max 90)
+    set_fifo_priority(&net_attr, NETWORK_PRIORITY, &topo.control_cpus);
+    set_fifo_priority(&sv_attr, SUPERVISOR_PRIORITY, &topo.control_cpus);
 
     if (pthread_create(&sv_thread, &sv_attr, supervisor_entry, &supervisor) != 0) {
         fprintf(stderr, "[Main] CRITICAL: Failed to create Supervisor thread\n");
@@ -101,11 +361,21 @@ int main(void) {
         return EXIT_FAILURE;
     }
 
+    if (shm_server_enabled() && pthread_create(&shm_thread, &net_attr, shm_entry, &supervisor) != 0) {
+        fprintf(stderr, "[Main] Failed to create shared-memory channel thread, channel disabled\n");
+        shm_server_cleanup();
+    }
+
     pthread_join(sv_thread, NULL);
     pthread_join(net_thread, NULL);
+    if (shm_server_enabled()) pthread_join(shm_thread, NULL);
 
+    metrics_http_stop();
     tcp_server_cleanup(&server);
+    shm_server_cleanup();
+    aperiodic_stop();
     runtime_cleanup();
+    checkpoint_close();
 
     return EXIT_SUCCESS;
 }
\ No newline at end of file
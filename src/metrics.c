@@ -0,0 +1,202 @@
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <poll.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <arpa/inet.h>
+#include "constants.h"
+#include "metrics.h"
+
+#define HTTP_POLL_TIMEOUT_MS 200
+
+typedef struct {
+    const char *name;
+    const char *type;
+    const char *labels; // Printed verbatim inside braces, NULL for none
+} MetricDesc;
+
+static const MetricDesc counter_desc[METRIC_COUNTER_COUNT] = {
+    [METRIC_COMMANDS] = {"dpt_commands_total", "counter", NULL},
+    [METRIC_INVALID_COMMANDS] = {"dpt_invalid_commands_total", "counter", NULL},
+    [METRIC_QUEUE_REJECTS] = {"dpt_queue_rejections_total", "counter", NULL},
+    [METRIC_ADMISSIONS] = {"dpt_admissions_total", "counter", NULL},
+    [METRIC_REJECT_UNKNOWN] = {"dpt_admission_rejections_total", "counter", "reason=\"unknown_task\""},
+    [METRIC_REJECT_UTILIZATION] = {"dpt_admission_rejections_total", "counter", "reason=\"utilization\""},
+    [METRIC_REJECT_RTA] = {"dpt_admission_rejections_total", "counter", "reason=\"rta\""},
+    [METRIC_REJECT_FULL] = {"dpt_admission_rejections_total", "counter", "reason=\"full\""},
+    [METRIC_DEACTIVATIONS] = {"dpt_deactivations_total", "counter", NULL},
+    [METRIC_CONNECTIONS] = {"dpt_connections_total", "counter", NULL},
+    [METRIC_CONNECTIONS_REJECTED] = {"dpt_connections_rejected_total", "counter", NULL},
+    [METRIC_JOBS] = {"dpt_jobs_total", "counter", NULL},
+    [METRIC_DEADLINE_MISSES] = {"dpt_deadline_misses_total", "counter", NULL},
+    [METRIC_JOBS_CANCELLED] = {"dpt_jobs_cancelled_total", "counter", NULL},
+    [METRIC_JOBS_DROPPED] = {"dpt_jobs_dropped_total", "counter", NULL},
+    [METRIC_JOBS_OVERRUN] = {"dpt_jobs_overrun_total", "counter", NULL},
+    [METRIC_MODE_SWITCHES] = {"dpt_criticality_mode_switches_total", "counter", NULL},
+    [METRIC_BUDGET_THROTTLES] = {"dpt_budget_throttles_total", "counter", NULL},
+    [METRIC_BUSY_NS] = {"dpt_cpu_busy_nanoseconds_total", "counter", "cpu"},
+    [METRIC_APERIODIC_SUBMITTED] = {"dpt_aperiodic_jobs_total", "counter", "state=\"submitted\""},
+    [METRIC_APERIODIC_COMPLETED] = {"dpt_aperiodic_jobs_total", "counter", "state=\"completed\""},
+    [METRIC_APERIODIC_REJECTED] = {"dpt_aperiodic_jobs_total", "counter", "state=\"rejected\""},
+};
+
+static const MetricDesc gauge_desc[METRIC_GAUGE_COUNT] = {
+    [GAUGE_QUEUE_DEPTH] = {"dpt_event_queue_depth", "gauge", NULL},
+    [GAUGE_QUEUE_HIGH_WATER] = {"dpt_event_queue_high_water", "gauge", NULL},
+    [GAUGE_CONNECTIONS_OPEN] = {"dpt_connections_open", "gauge", NULL},
+    [GAUGE_ACTIVE_INSTANCES] = {"dpt_active_instances", "gauge", NULL},
+    [GAUGE_ADMITTED_UTILIZATION_PPM] = {"dpt_cpu_admitted_utilization_ppm", "gauge", "cpu"},
+    [GAUGE_CRITICALITY_MODE] = {"dpt_criticality_mode", "gauge", NULL}, // 0 LO, 1 HI
+    [GAUGE_RESERVATIONS] = {"dpt_reservations", "gauge", NULL},
+};
+
+static atomic_ullong counters[METRIC_COUNTER_COUNT];
+static atomic_llong gauges[METRIC_GAUGE_COUNT];
+static int metrics_cpu = CPU_NUMBER;
+
+static pthread_t http_thread;
+static atomic_bool http_running = false;
+static int http_fd = -1;
+
+void metrics_init(const int task_cpu) {
+    metrics_cpu = task_cpu;
+    for (int i = 0; i < METRIC_COUNTER_COUNT; i++) atomic_store(&counters[i], 0);
+    for (int i = 0; i < METRIC_GAUGE_COUNT; i++) atomic_store(&gauges[i], 0);
+}
+
+void metrics_inc(const MetricCounter counter) {
+    atomic_fetch_add_explicit(&counters[counter], 1, memory_order_relaxed);
+}
+
+void metrics_add(const MetricCounter counter, const unsigned long long value) {
+    atomic_fetch_add_explicit(&counters[counter], value, memory_order_relaxed);
+}
+
+void metrics_gauge_set(const MetricGauge gauge, const long long value) {
+    atomic_store_explicit(&gauges[gauge], value, memory_order_relaxed);
+}
+
+void metrics_gauge_add(const MetricGauge gauge, const long long delta) {
+    atomic_fetch_add_explicit(&gauges[gauge], delta, memory_order_relaxed);
+}
+
+void metrics_gauge_max(const MetricGauge gauge, const long long value) {
+    long long current = atomic_load_explicit(&gauges[gauge], memory_order_relaxed);
+    while (current < value &&
+           !atomic_compare_exchange_weak_explicit(&gauges[gauge], &current, value,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
+/*
+ * Appends one sample, preceded by its TYPE line unless the previous
+ * sample belonged to the same metric family.
+ */
+static int format_sample(char *buf, const size_t len, const MetricDesc *desc, const char *prev_name,
+                         const long long value) {
+    int off = 0;
+    if (!prev_name || strcmp(prev_name, desc->name) != 0) {
+        off += snprintf(buf, len, "# TYPE %s %s\n", desc->name, desc->type);
+    }
+    if (off >= (int) len) return off;
+
+    if (!desc->labels) {
+        off += snprintf(buf + off, len - off, "%s %lld\n", desc->name, value);
+    } else if (strcmp(desc->labels, "cpu") == 0) {
+        off += snprintf(buf + off, len - off, "%s{cpu=\"%d\"} %lld\n", desc->name, metrics_cpu, value);
+    } else {
+        off += snprintf(buf + off, len - off, "%s{%s} %lld\n", desc->name, desc->labels, value);
+    }
+    return off;
+}
+
+int metrics_format(char *buf, const size_t len) {
+    int off = 0;
+    const char *prev = NULL;
+    buf[0] = '\0';
+
+    for (int i = 0; i < METRIC_COUNTER_COUNT && off < (int) len; i++) {
+        const long long value = (long long) atomic_load_explicit(&counters[i], memory_order_relaxed);
+        off += format_sample(buf + off, len - off, &counter_desc[i], prev, value);
+        prev = counter_desc[i].name;
+    }
+    for (int i = 0; i < METRIC_GAUGE_COUNT && off < (int) len; i++) {
+        const long long value = atomic_load_explicit(&gauges[i], memory_order_relaxed);
+        off += format_sample(buf + off, len - off, &gauge_desc[i], prev, value);
+        prev = gauge_desc[i].name;
+    }
+    return off < (int) len ? off : (int) len - 1;
+}
+
+static void http_serve(const int fd) {
+    char request[1024];
+    char body[NET_RESPONSE_BUF_SIZE];
+    char header[128];
+
+    // The request is only drained: every path returns the metrics page
+    struct pollfd pfd = {.fd = fd, .events = POLLIN};
+    if (poll(&pfd, 1, HTTP_POLL_TIMEOUT_MS) > 0) {
+        if (recv(fd, request, sizeof(request), 0) <= 0) return;
+    }
+
+    const int body_len = metrics_format(body, sizeof(body));
+    const int header_len = snprintf(header, sizeof(header),
+                                    "HTTP/1.0 200 OK\r\n"
+                                    "Content-Type: text/plain; version=0.0.4\r\n"
+                                    "Content-Length: %d\r\n\r\n", body_len);
+    send(fd, header, header_len, MSG_NOSIGNAL);
+    send(fd, body, body_len, MSG_NOSIGNAL);
+}
+
+static void *http_entry(void *arg) {
+    (void) arg;
+    struct pollfd pfd = {.fd = http_fd, .events = POLLIN};
+    while (atomic_load(&http_running)) {
+        if (poll(&pfd, 1, HTTP_POLL_TIMEOUT_MS) <= 0) continue;
+        const int client = accept(http_fd, NULL, NULL);
+        if (client < 0) continue;
+        http_serve(client);
+        close(client);
+    }
+    return NULL;
+}
+
+int metrics_http_start(const int port) {
+    const int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+
+    const int opt = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+    struct sockaddr_in address = {
+        .sin_family = AF_INET,
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+        .sin_port = htons(port)
+    };
+    if (bind(fd, (struct sockaddr *) &address, sizeof(address)) < 0 || listen(fd, BACKLOG_SIZE) < 0) {
+        perror("[Metrics] Failed to open HTTP endpoint");
+        close(fd);
+        return -1;
+    }
+
+    http_fd = fd;
+    atomic_store(&http_running, true);
+    if (pthread_create(&http_thread, NULL, http_entry, NULL) != 0) {
+        atomic_store(&http_running, false);
+        close(fd);
+        http_fd = -1;
+        return -1;
+    }
+
+    printf("[Metrics] HTTP endpoint on 127.0.0.1:%d\n", port);
+    return 0;
+}
+
+void metrics_http_stop(void) {
+    if (!atomic_load(&http_running)) return;
+    atomic_store(&http_running, false);
+    pthread_join(http_thread, NULL);
+    close(http_fd);
+    http_fd = -1;
+}
@@ -0,0 +1,306 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <sys/socket.h>
+#include "constants.h"
+#include "overhead.h"
+
+#include "analysis.h"
+#include "event.h"
+#include "task_config.h"
+
+#define NSEC_PER_SEC 1000000000LL
+#define NSEC_PER_USEC 1000LL
+#define OVERHEAD_PRIORITY 90            // Top of the task range, like the jobs being modeled
+#define SWITCH_ROUNDS 2000
+#define RELEASE_SAMPLES 1000
+#define RELEASE_STEP_NS 200000LL
+#define COMMAND_ROUNDS 2000
+#define EVENT_ROUNDS 20
+#define CONTROL_WINDOW_BITS 24
+#define CONTROL_WINDOW_MASK ((1ULL << CONTROL_WINDOW_BITS) - 1)
+
+typedef struct {
+    int cpu;
+    OverheadModel model;
+    int result;
+} Calibration;
+
+static long long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long) ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+static struct timespec to_timespec(const long long ns) {
+    const struct timespec ts = {.tv_sec = ns / NSEC_PER_SEC, .tv_nsec = ns % NSEC_PER_SEC};
+    return ts;
+}
+
+static long long to_us(const double ns) {
+    const long long us = (long long) (ns / NSEC_PER_USEC + 0.999);
+    return us > 0 ? us : 1;
+}
+
+/*
+ * Spawns a thread on 'cpu' at the calibration priority, falling back to
+ * the default policy without privileges.
+ */
+static int spawn_on(const int cpu, pthread_t *thread, void *(*fn)(void *), void *arg) {
+    pthread_attr_t attr;
+    cpu_set_t cpus;
+    const struct sched_param param = {.sched_priority = OVERHEAD_PRIORITY};
+
+    CPU_ZERO(&cpus);
+    CPU_SET(cpu, &cpus);
+    pthread_attr_init(&attr);
+    pthread_attr_setaffinity_np(&attr, sizeof(cpus), &cpus);
+    pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+    pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+    pthread_attr_setschedparam(&attr, &param);
+    int err = pthread_create(thread, &attr, fn, arg);
+    if (err != 0) {
+        pthread_attr_setschedpolicy(&attr, SCHED_OTHER);
+        const struct sched_param other = {.sched_priority = 0};
+        pthread_attr_setschedparam(&attr, &other);
+        err = pthread_create(thread, &attr, fn, arg);
+    }
+    pthread_attr_destroy(&attr);
+    return err == 0 ? 0 : -1;
+}
+
+static void *pong_entry(void *arg) {
+    const int fd = *(int *) arg;
+    char c;
+    while (read(fd, &c, 1) == 1 && c != 'q') {
+        if (write(fd, &c, 1) != 1) break;
+    }
+    return NULL;
+}
+
+static void *empty_entry(void *arg) {
+    return arg;
+}
+
+/* Ping-pong over a socketpair with a thread on the same core: every round trip is two switches. */
+static long long measure_switch_ns(const int cpu) {
+    int fds[2];
+    pthread_t pong;
+    char c = 'p';
+
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) return -1;
+    if (spawn_on(cpu, &pong, pong_entry, &fds[1]) != 0) {
+        close(fds[0]);
+        close(fds[1]);
+        return -1;
+    }
+    const long long start = now_ns();
+    for (int i = 0; i < SWITCH_ROUNDS; i++) {
+        if (write(fds[0], &c, 1) != 1 || read(fds[0], &c, 1) != 1) break;
+    }
+    const long long elapsed = now_ns() - start;
+    c = 'q';
+    if (write(fds[0], &c, 1) != 1) pthread_cancel(pong);
+    pthread_join(pong, NULL);
+    close(fds[0]);
+    close(fds[1]);
+    return elapsed / (2LL * SWITCH_ROUNDS);
+}
+
+static int compare_ll(const void *a, const void *b) {
+    const long long x = *(const long long *) a;
+    const long long y = *(const long long *) b;
+    return (x > y) - (x < y);
+}
+
+/* 99th percentile lateness of absolute timed wake-ups, the path every job release takes. */
+static long long measure_release_ns(void) {
+    static long long late[RELEASE_SAMPLES];
+    for (int i = 0; i < RELEASE_SAMPLES; i++) {
+        const long long target = now_ns() + RELEASE_STEP_NS;
+        const struct timespec ts = to_timespec(target);
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+        late[i] = now_ns() - target;
+    }
+    qsort(late, RELEASE_SAMPLES, sizeof(long long), compare_ll);
+    return late[RELEASE_SAMPLES * 99 / 100];
+}
+
+/*
+ * Largest reply the network thread formats itself: a full page of LIST
+ * lines. INFO and METRICS replies are formatted the same way and bounded by
+ * the same buffer.
+ */
+static size_t format_full_page(char *resp, const size_t len, const int round) {
+    size_t off = (size_t) snprintf(resp, len, "[SERVER]: Running: %d (version %d)\n", MAX_INSTANCES, round);
+    for (int i = 0; len - off >= 100; i++) {
+        const TaskType *t = &tasks_config.tasks[i % N_TASKS];
+        off += (size_t) snprintf(resp + off, len - off, "  [ID %d] %s (C=%ld, T=%ld, O=%ld) in %s\n",
+                                 i, t->name, t->wcet_ms, t->period_ms, t->period_ms / 2, t->name);
+    }
+    return off;
+}
+
+/*
+ * Network path of one command: receive the line, parse it, format and send
+ * the reply. Write commands only forward an event; read commands (LIST,
+ * INFO, METRICS) are answered on the network thread, so the mean of the
+ * costlier kind is returned.
+ */
+static long long measure_command_ns(void) {
+    static const char *const lines[] = {"ACTIVATE t1 0\n", "LIST\n"};
+    char buf[NET_BUFFER_SIZE];
+    char resp[NET_RESPONSE_BUF_SIZE];
+    int fds[2];
+    Event ev;
+    long long worst = 0;
+
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) return -1;
+    for (int kind = 0; kind < 2; kind++) {
+        long long total = 0;
+        for (int i = 0; i < COMMAND_ROUNDS; i++) {
+            if (write(fds[0], lines[kind], strlen(lines[kind])) < 0) break;
+            const long long start = now_ns();
+            const ssize_t n = recv(fds[1], buf, sizeof(buf) - 1, 0);
+            if (n <= 0) break;
+            buf[n] = '\0';
+            buf[strcspn(buf, "\r\n")] = '\0';
+            event_parse(buf, fds[1], &ev);
+            const size_t len = ev.type == EV_LIST ? format_full_page(resp, sizeof(resp), i)
+                                                  : (size_t) snprintf(resp, sizeof(resp), "[SERVER]: OK ID=%d\n", i);
+            send(fds[1], resp, len, MSG_NOSIGNAL);
+            total += now_ns() - start;
+            for (size_t got = 0; got < len;) { // Drained outside the measurement
+                const ssize_t r = recv(fds[0], buf, sizeof(buf), 0);
+                if (r <= 0) break;
+                got += (size_t) r;
+            }
+        }
+        if (total / COMMAND_ROUNDS > worst) worst = total / COMMAND_ROUNDS;
+    }
+    close(fds[0]);
+    close(fds[1]);
+    return worst;
+}
+
+/*
+ * Supervisor path of the heaviest event: response time analysis in both modes and elastic
+ * compression of an overloaded full set, then spawning an instance thread.
+ * Returns the median, so a preempted sample does not skew the model.
+ */
+static long long measure_event_ns(const int cpu) {
+    AnalysisTask set[MAX_INSTANCES + 1];
+    AnalysisTask work[MAX_INSTANCES + 1];
+    long long samples[EVENT_ROUNDS];
+    const int count = MAX_INSTANCES + 1;
+
+    for (int i = 0; i < count; i++) {
+        const TaskType *type = &tasks_config.tasks[i % N_TASKS];
+        set[i] = (AnalysisTask){
+            .name = type->name,
+            .wcet_us = type->wcet_ms * 1000LL,
+            .wcet_hi_us = task_wcet_ms(type, CRIT_HI) * 1000LL,
+            .criticality = type->criticality,
+            .period_us = type->period_ms * 1000LL,
+            .deadline_us = type->deadline_ms * 1000LL,
+            .period_max_us = (type->period_max_ms > type->period_ms ? type->period_max_ms : type->period_ms) * 1000LL,
+            .elasticity = type->elasticity,
+            .ref = i,
+            .tiebreak = i
+        };
+    }
+    for (int r = 0; r < EVENT_ROUNDS; r++) {
+        pthread_t thread;
+        const long long start = now_ns();
+        memcpy(work, set, sizeof(set));
+        analysis_rta(work, count, NULL);
+        analysis_amc_hi(work, count, NULL);
+        memcpy(work, set, sizeof(set));
+        analysis_elastic(work, count);
+        if (spawn_on(cpu, &thread, empty_entry, NULL) == 0) pthread_join(thread, NULL);
+        samples[r] = now_ns() - start;
+    }
+    qsort(samples, EVENT_ROUNDS, sizeof(long long), compare_ll);
+    return samples[EVENT_ROUNDS / 2];
+}
+
+static void *calibration_entry(void *arg) {
+    Calibration *cal = arg;
+    const long long switch_ns = measure_switch_ns(cal->cpu);
+    const long long release_ns = measure_release_ns();
+    const long long command_ns = measure_command_ns();
+    const long long event_ns = measure_event_ns(cal->cpu);
+
+    if (switch_ns < 0 || command_ns < 0) {
+        cal->result = -1;
+        return NULL;
+    }
+    cal->model.context_switch_us = to_us((double) switch_ns);
+    cal->model.release_us = to_us((double) release_ns);
+    cal->model.command_us = to_us((double) command_ns * OVERHEAD_MARGIN);
+    cal->model.event_us = to_us((double) event_ns * OVERHEAD_MARGIN);
+    cal->result = 0;
+    return NULL;
+}
+
+int overhead_calibrate(const int cpu, OverheadModel *out) {
+    Calibration cal = {.cpu = cpu, .result = -1};
+    pthread_t thread;
+
+    memset(out, 0, sizeof(*out));
+    printf("[Overhead] Calibrating on CPU %d...\n", cpu);
+    if (spawn_on(cpu, &thread, calibration_entry, &cal) != 0) {
+        fprintf(stderr, "[Overhead] Failed to start calibration, overheads ignored\n");
+        return -1;
+    }
+    pthread_join(thread, NULL);
+    if (cal.result != 0) {
+        fprintf(stderr, "[Overhead] Calibration failed, overheads ignored\n");
+        return -1;
+    }
+    *out = cal.model;
+    printf("[Overhead] Context switch %lld us, release %lld us, command %lld us, event %lld us\n",
+           out->context_switch_us, out->release_us, out->command_us, out->event_us);
+    return 0;
+}
+
+long long overhead_job_us(const OverheadModel *model) {
+    return model->release_us + 2 * model->context_switch_us;
+}
+
+static long long window_index(void) {
+    return now_ns() / (CONTROL_INTERVAL_MS * 1000000LL);
+}
+
+/* Admissions already counted in the current window, given the packed state. */
+static int window_used(const unsigned long long state, const long long index) {
+    return (long long) (state >> CONTROL_WINDOW_BITS) == index ? (int) (state & CONTROL_WINDOW_MASK) : 0;
+}
+
+bool control_window_available(ControlWindow *win, const int budget) {
+    return budget <= 0 || window_used(atomic_load(&win->state), window_index()) < budget;
+}
+
+bool control_window_take(ControlWindow *win, const int budget) {
+    unsigned long long state = atomic_load(&win->state);
+    for (;;) {
+        const long long index = window_index();
+        const int used = window_used(state, index);
+        if (budget > 0 && used >= budget) return false;
+        const unsigned long long next = (unsigned long long) index << CONTROL_WINDOW_BITS | (unsigned long long) (used + 1);
+        if (atomic_compare_exchange_weak(&win->state, &state, next)) return true;
+    }
+}
+
+void control_window_wait(void) {
+    const struct timespec ts = to_timespec((window_index() + 1) * CONTROL_INTERVAL_MS * 1000000LL);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+        // Interrupted by a signal: the deadline is absolute, sleep again
+    }
+}
@@ -0,0 +1,41 @@
+#include "periodic.h"
+
+/*
+ * Returns the first release offset + k * period that is not before 'from_ns'.
+ */
+static long long grid_release(const long long offset_ns, const long long period_ns, const long long from_ns) {
+    long long k = 0;
+    const long long elapsed = from_ns - offset_ns;
+    if (elapsed > 0) k = (elapsed + period_ns - 1) / period_ns;
+    return offset_ns + k * period_ns;
+}
+
+void periodic_init(PeriodicClock *clk, const long long offset_ns, const long long nominal_period_ns,
+                   const long long period_ns, const long long now_ns) {
+    clk->offset_ns = offset_ns;
+    clk->nominal_period_ns = nominal_period_ns;
+    clk->period_ns = period_ns;
+    clk->release_ns = grid_release(offset_ns, period_ns, now_ns);
+}
+
+void periodic_resume(PeriodicClock *clk, const long long offset_ns, const long long nominal_period_ns,
+                     const long long period_ns, const long long anchor_ns, const long long now_ns) {
+    periodic_init(clk, offset_ns, nominal_period_ns, period_ns, now_ns);
+    if (anchor_ns >= 0 && period_ns != nominal_period_ns) {
+        const long long phase = anchor_ns % period_ns;
+        clk->release_ns = grid_release(phase, period_ns, now_ns);
+    }
+}
+
+void periodic_advance(PeriodicClock *clk, const long long period_ns) {
+    clk->release_ns += period_ns;
+    if (period_ns != clk->period_ns && period_ns == clk->nominal_period_ns) {
+        // Back to nominal: re-align to the epoch grid so the offset analysis holds again
+        clk->release_ns = grid_release(clk->offset_ns, period_ns, clk->release_ns);
+    }
+    clk->period_ns = period_ns;
+}
+
+long long periodic_deadline(const PeriodicClock *clk, const long long deadline_ns) {
+    return clk->release_ns + deadline_ns;
+}
@@ -0,0 +1,126 @@
+#include <math.h>
+#include <string.h>
+#include <pthread.h>
+#include "constants.h"
+#include "profiler.h"
+
+#define BUCKETS_PER_WCET 100
+#define HISTOGRAM_BUCKETS (4 * BUCKETS_PER_WCET) // Covers up to 4x the declared WCET
+#define BLOCK_SIZE 20                            // Jobs per block maximum
+#define MAX_BLOCKS 256
+#define MIN_BLOCKS 10
+#define EVT_EXCEEDANCE 1e-9                      // Per-job probability of exceeding the estimate
+#define EULER_GAMMA 0.5772156649
+
+typedef struct {
+    pthread_mutex_t mutex;
+    long long bucket_ns;
+    unsigned long long histogram[HISTOGRAM_BUCKETS + 1]; // Last bucket counts overflows
+    unsigned long long samples;
+    long long max_ns;
+    unsigned long long overruns;
+    long long block_max_ns;
+    int block_fill;
+    long long blocks[MAX_BLOCKS]; // Ring of block maxima
+    int block_count;
+    int block_next;
+} TaskStats;
+
+static TaskStats stats[N_TASKS];
+
+void profiler_init(const TasksConfig *config) {
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_setprotocol(&attr, PTHREAD_PRIO_INHERIT); // Shared by tasks of different priorities
+
+    for (int i = 0; i < N_TASKS; i++) {
+        memset(&stats[i], 0, sizeof(TaskStats));
+        pthread_mutex_init(&stats[i].mutex, &attr);
+        stats[i].bucket_ns = config->tasks[i].wcet_ms * 1000000LL / BUCKETS_PER_WCET;
+        if (stats[i].bucket_ns <= 0) stats[i].bucket_ns = 1;
+    }
+    pthread_mutexattr_destroy(&attr);
+}
+
+void profiler_record(const int task, const long long exec_ns) {
+    TaskStats *s = &stats[task];
+    long long bucket = exec_ns / s->bucket_ns;
+    if (bucket > HISTOGRAM_BUCKETS) bucket = HISTOGRAM_BUCKETS;
+
+    pthread_mutex_lock(&s->mutex);
+    s->histogram[bucket]++;
+    s->samples++;
+    if (exec_ns > s->max_ns) s->max_ns = exec_ns;
+
+    if (exec_ns > s->block_max_ns) s->block_max_ns = exec_ns;
+    if (++s->block_fill == BLOCK_SIZE) {
+        s->blocks[s->block_next] = s->block_max_ns;
+        s->block_next = (s->block_next + 1) % MAX_BLOCKS;
+        if (s->block_count < MAX_BLOCKS) s->block_count++;
+        s->block_fill = 0;
+        s->block_max_ns = 0;
+    }
+    pthread_mutex_unlock(&s->mutex);
+}
+
+void profiler_record_overrun(const int task, const long long exec_ns) {
+    TaskStats *s = &stats[task];
+    pthread_mutex_lock(&s->mutex);
+    s->overruns++;
+    if (exec_ns > s->max_ns) s->max_ns = exec_ns;
+    pthread_mutex_unlock(&s->mutex);
+}
+
+/*
+ * Fits a Gumbel distribution to the block maxima by the method of moments
+ * and returns the quantile matching EVT_EXCEEDANCE per job.
+ */
+static double gumbel_estimate_ms(const long long *blocks, const int count) {
+    double mean = 0, var = 0;
+    for (int i = 0; i < count; i++) mean += (double) blocks[i];
+    mean /= count;
+    for (int i = 0; i < count; i++) var += ((double) blocks[i] - mean) * ((double) blocks[i] - mean);
+    var /= count - 1;
+
+    const double beta = sqrt(6.0 * var) / M_PI;
+    const double mu = mean - EULER_GAMMA * beta;
+    const double p_block = 1.0 - pow(1.0 - EVT_EXCEEDANCE, BLOCK_SIZE);
+    return (mu - beta * log(-log(1.0 - p_block))) / 1e6;
+}
+
+void profiler_get(const int task, WcetProfile *out) {
+    unsigned long long histogram[HISTOGRAM_BUCKETS + 1];
+    long long blocks[MAX_BLOCKS];
+    TaskStats *s = &stats[task];
+
+    pthread_mutex_lock(&s->mutex);
+    memcpy(histogram, s->histogram, sizeof(histogram));
+    memcpy(blocks, s->blocks, sizeof(blocks));
+    const int block_count = s->block_count;
+    const long long bucket_ns = s->bucket_ns;
+    out->samples = s->samples;
+    out->max_ms = (double) s->max_ns / 1e6;
+    out->overruns = s->overruns;
+    pthread_mutex_unlock(&s->mutex);
+
+    out->p99_ms = 0;
+    const unsigned long long target = (unsigned long long) ceil(0.99 * (double) out->samples);
+    unsigned long long cumulative = 0;
+    for (int b = 0; b <= HISTOGRAM_BUCKETS && out->samples > 0; b++) {
+        cumulative += histogram[b];
+        if (cumulative >= target) {
+            const double upper = (double) ((b + 1) * bucket_ns) / 1e6;
+            out->p99_ms = (b == HISTOGRAM_BUCKETS || upper > out->max_ms) ? out->max_ms : upper;
+            break;
+        }
+    }
+
+    out->evt_ms = block_count >= MIN_BLOCKS ? gumbel_estimate_ms(blocks, block_count) : -1;
+}
+
+double profiler_bound_ms(const int task) {
+    WcetProfile p;
+    profiler_get(task, &p);
+    if (p.samples < PROFILE_MIN_SAMPLES) return -1;
+    return p.evt_ms > p.max_ms ? p.evt_ms : p.max_ms;
+}
@@ -0,0 +1,31 @@
+#include <stdio.h>
+#include "reply.h"
+
+#include "shm_server.h"
+#include "tcp_server.h"
+
+void reply_status(const Event *ev, const EventStatus status, const long long value) {
+    char resp[64];
+
+    if (ev->channel == REPLY_SHM) {
+        shm_server_complete(ev->client_fd, status, value);
+        return;
+    }
+    // Text is only formatted for TCP clients
+    if (status != STATUS_OK) snprintf(resp, sizeof(resp), "%s\n", event_status_text(status));
+    else if (ev->type == EV_ACTIVATE) snprintf(resp, sizeof(resp), "OK ID=%lld\n", value);
+    else if (ev->type == EV_SUBMIT) snprintf(resp, sizeof(resp), "OK JOB=%lld\n", value);
+    else if (ev->type == EV_SHUTDOWN) snprintf(resp, sizeof(resp), "OK Shutting Down\n");
+    else snprintf(resp, sizeof(resp), "OK\n");
+    tcp_server_send_response(ev->client_fd, resp);
+}
+
+void reply_text(const Event *ev, const EventStatus status, const char *text, const bool first, const bool last) {
+    if (ev->channel == REPLY_SHM) {
+        shm_server_append(ev->client_fd, text, first);
+        if (last) shm_server_complete(ev->client_fd, status, 0);
+        return;
+    }
+    if (first) tcp_server_send_response(ev->client_fd, text);
+    else tcp_server_send_raw(ev->client_fd, text);
+}
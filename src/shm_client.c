@@ -0,0 +1,115 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include "shm_channel.h"
+
+#define NSEC_PER_SEC 1000000000LL
+#define NSEC_PER_MSEC 1000000LL
+#define SPIN_NS 50000LL // Longer than a typical served command, far shorter than a sleep/wake-up pair
+
+static long long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long) ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+static void cpu_relax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+void shm_futex_wait(atomic_uint *word, const unsigned int expected, const long long timeout_ns) {
+    const struct timespec ts = {.tv_sec = timeout_ns / NSEC_PER_SEC, .tv_nsec = timeout_ns % NSEC_PER_SEC};
+    // Shared futex (no FUTEX_PRIVATE_FLAG): the other side is another process
+    syscall(SYS_futex, word, FUTEX_WAIT, expected, timeout_ns >= 0 ? &ts : NULL, NULL, 0);
+}
+
+void shm_futex_wake(atomic_uint *word, const int count) {
+    syscall(SYS_futex, word, FUTEX_WAKE, count, NULL, NULL, 0);
+}
+
+ShmChannel *shm_client_open(const char *name) {
+    struct stat st;
+    const int fd = shm_open(name, O_RDWR, 0);
+    if (fd < 0) return NULL;
+    if (fstat(fd, &st) != 0 || st.st_size != (off_t) sizeof(ShmChannel)) {
+        close(fd);
+        return NULL;
+    }
+    ShmChannel *ch = mmap(NULL, sizeof(ShmChannel), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (ch == MAP_FAILED) return NULL;
+    if (memcmp(ch->magic, SHM_CHANNEL_MAGIC, sizeof(ch->magic)) != 0 ||
+        ch->slot_count != SHM_SLOTS || ch->slot_size != sizeof(ShmSlot)) {
+        munmap(ch, sizeof(ShmChannel));
+        return NULL;
+    }
+    return ch;
+}
+
+void shm_client_close(ShmChannel *ch) {
+    if (ch) munmap(ch, sizeof(ShmChannel));
+}
+
+/* Claims a free slot, starting from a per-thread position so clients rarely collide. */
+static ShmSlot *claim_slot(ShmChannel *ch, const long long deadline) {
+    static _Thread_local unsigned int next;
+    for (;;) {
+        for (int k = 0; k < SHM_SLOTS; k++) {
+            const unsigned int i = (next + (unsigned int) k) % SHM_SLOTS;
+            unsigned int expected = SHM_SLOT_FREE;
+            if (atomic_compare_exchange_strong(&ch->slots[i].state, &expected, SHM_SLOT_CLAIMED)) {
+                next = i + 1;
+                return &ch->slots[i];
+            }
+        }
+        if (now_ns() >= deadline) return NULL;
+        sched_yield();
+    }
+}
+
+int shm_client_call(ShmChannel *ch, const Event *req, ShmResult *out, char *text, const size_t text_size,
+                    const int timeout_ms) {
+    const long long start = now_ns();
+    const long long deadline = start + timeout_ms * NSEC_PER_MSEC;
+    ShmSlot *slot = claim_slot(ch, deadline);
+    if (!slot) return -1;
+
+    slot->request = *req;
+    atomic_store(&slot->state, SHM_SLOT_REQUEST);
+    atomic_fetch_add(&ch->doorbell, 1);
+    if (atomic_load(&ch->sleeping)) shm_futex_wake(&ch->doorbell, 1);
+
+    unsigned int state;
+    while ((state = atomic_load(&slot->state)) != SHM_SLOT_DONE) {
+        const long long now = now_ns();
+        if (now >= deadline) {
+            // Not taken yet: withdraw it. Taken: the server frees it once answered.
+            const unsigned int next = state == SHM_SLOT_REQUEST ? SHM_SLOT_FREE : SHM_SLOT_ABANDONED;
+            if (atomic_compare_exchange_strong(&slot->state, &state, next)) return -1;
+            continue;
+        }
+        if (now - start < SPIN_NS) cpu_relax();
+        else shm_futex_wait(&slot->state, state, deadline - now);
+    }
+
+    out->status = (EventStatus) slot->status;
+    out->value = slot->value;
+    if (text && text_size > 0) {
+        size_t n = slot->text_len < sizeof(slot->text) - 1 ? slot->text_len : sizeof(slot->text) - 1;
+        if (n > text_size - 1) n = text_size - 1;
+        memcpy(text, slot->text, n);
+        text[n] = '\0';
+    }
+    atomic_store(&slot->state, SHM_SLOT_FREE);
+    return 0;
+}
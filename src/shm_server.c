@@ -0,0 +1,151 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "shm_server.h"
+#include "shm_channel.h"
+
+#include "metrics.h"
+#include "overhead.h"
+
+#define DOORBELL_TIMEOUT_NS 100000000LL // Same as the TCP poll timeout: notices shutdown
+
+#define TRUNCATED_MARK "...\n[truncated]\n"
+
+static ShmChannel *channel;
+static char channel_name[64];
+// Reply lengths are kept here: the slots are writable by every client, so text_len is only an output
+static size_t text_lens[SHM_SLOTS];
+static bool text_truncated[SHM_SLOTS];
+
+int shm_server_init(const char *name) {
+    snprintf(channel_name, sizeof(channel_name), "%s", name);
+    shm_unlink(channel_name); // Slots of a dead server would hold stale requests
+    const int fd = shm_open(channel_name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0) {
+        perror("[Shm] shm_open");
+        return -1;
+    }
+    if (ftruncate(fd, sizeof(ShmChannel)) != 0) {
+        perror("[Shm] ftruncate");
+        close(fd);
+        shm_unlink(channel_name);
+        return -1;
+    }
+    ShmChannel *ch = mmap(NULL, sizeof(ShmChannel), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (ch == MAP_FAILED) {
+        perror("[Shm] mmap");
+        shm_unlink(channel_name);
+        return -1;
+    }
+
+    memset(ch, 0, sizeof(*ch));
+    ch->slot_count = SHM_SLOTS;
+    ch->slot_size = sizeof(ShmSlot);
+    atomic_init(&ch->doorbell, 0);
+    atomic_init(&ch->sleeping, 0);
+    for (int i = 0; i < SHM_SLOTS; i++) atomic_init(&ch->slots[i].state, SHM_SLOT_FREE);
+    atomic_thread_fence(memory_order_release);
+    memcpy(ch->magic, SHM_CHANNEL_MAGIC, sizeof(ch->magic)); // Last: clients accept the channel from here on
+    channel = ch;
+
+    printf("[Shm] Command channel at /dev/shm%s (%d slots)\n", channel_name, SHM_SLOTS);
+    return 0;
+}
+
+bool shm_server_enabled(void) {
+    return channel != NULL;
+}
+
+/*
+ * Serves one taken slot. The request is binary, so it is validated rather
+ * than parsed before being dispatched like a TCP command.
+ */
+static void serve_slot(Supervisor *spv, const int i) {
+    Event ev = channel->slots[i].request;
+    ev.channel = REPLY_SHM;
+    ev.client_fd = i;
+    text_lens[i] = 0;
+    text_truncated[i] = false;
+    channel->slots[i].text_len = 0;
+
+    metrics_inc(METRIC_COMMANDS);
+    if (event_validate(&ev) != 0) {
+        metrics_inc(METRIC_INVALID_COMMANDS);
+        shm_server_complete(i, STATUS_ERR_INVALID_COMMAND, 0);
+        return;
+    }
+    ev.admin = true; // Only the server's own user can open the channel
+    supervisor_dispatch(spv, ev);
+}
+
+void shm_server_poll(Supervisor *spv) {
+    const unsigned int bell = atomic_load(&channel->doorbell);
+    int served = 0;
+
+    for (int i = 0; i < SHM_SLOTS; i++) {
+        unsigned int expected = SHM_SLOT_REQUEST;
+        if (atomic_load(&channel->slots[i].state) != SHM_SLOT_REQUEST) continue;
+        if (!atomic_compare_exchange_strong(&channel->slots[i].state, &expected, SHM_SLOT_SERVING)) continue;
+        // Same budget as TCP commands: excess requests wait, they are not dropped
+        while (!control_window_take(&spv->command_window, spv->admission.command_budget)) control_window_wait();
+        serve_slot(spv, i);
+        served++;
+    }
+    if (served > 0) return;
+
+    // A request rung after 'bell' was read changes the doorbell, so the wait returns at once
+    atomic_store(&channel->sleeping, 1);
+    if (atomic_load(&channel->doorbell) == bell) shm_futex_wait(&channel->doorbell, bell, DOORBELL_TIMEOUT_NS);
+    atomic_store(&channel->sleeping, 0);
+}
+
+void shm_server_append(const int slot, const char *text, const bool first) {
+    ShmSlot *s = &channel->slots[slot];
+    if (first) {
+        text_lens[slot] = 0;
+        text_truncated[slot] = false;
+    }
+    if (text_truncated[slot]) return;
+
+    size_t len = text_lens[slot];
+    const size_t n = strlen(text);
+    if (n <= sizeof(s->text) - 1 - len) {
+        memcpy(s->text + len, text, n);
+        len += n;
+    } else {
+        // Cut where the marker still fits, so the client sees the reply is incomplete
+        const size_t keep = sizeof(s->text) - sizeof(TRUNCATED_MARK);
+        if (len > keep) len = keep;
+        memcpy(s->text + len, text, keep - len);
+        memcpy(s->text + keep, TRUNCATED_MARK, sizeof(TRUNCATED_MARK));
+        len = keep + sizeof(TRUNCATED_MARK) - 1;
+        text_truncated[slot] = true;
+    }
+    s->text[len] = '\0';
+    text_lens[slot] = len;
+    s->text_len = (uint32_t) len;
+}
+
+void shm_server_complete(const int slot, const EventStatus status, const long long value) {
+    ShmSlot *s = &channel->slots[slot];
+    s->status = status;
+    s->value = value;
+    unsigned int expected = SHM_SLOT_SERVING;
+    if (atomic_compare_exchange_strong(&s->state, &expected, SHM_SLOT_DONE)) {
+        shm_futex_wake(&s->state, 1);
+    } else if (expected == SHM_SLOT_ABANDONED) {
+        atomic_store(&s->state, SHM_SLOT_FREE); // The client timed out; nobody reads this reply
+    }
+}
+
+void shm_server_cleanup(void) {
+    if (!channel) return;
+    munmap(channel, sizeof(*channel));
+    shm_unlink(channel_name);
+    channel = NULL;
+}
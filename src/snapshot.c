@@ -0,0 +1,40 @@
+#include <string.h>
+#include <stdatomic.h>
+#include "snapshot.h"
+
+/*
+ * Seqlock: the sequence is odd while the writer updates the data.
+ * Readers copy optimistically and retry if the sequence moved under them.
+ */
+static atomic_ulong sequence;
+static ActiveSnapshot current;
+
+void snapshot_publish(const Task *set, const int count, const Reservation *reservations) {
+    const unsigned long seq = atomic_load_explicit(&sequence, memory_order_relaxed);
+    atomic_store_explicit(&sequence, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    current.count = count;
+    current.version = (seq + 2) / 2;
+    if (count > 0) memcpy(current.entries, set, sizeof(Task) * count);
+    memcpy(current.reservations, reservations, sizeof(current.reservations));
+
+    atomic_store_explicit(&sequence, seq + 2, memory_order_release);
+}
+
+void snapshot_read(ActiveSnapshot *out) {
+    unsigned long before, after;
+    do {
+        before = atomic_load_explicit(&sequence, memory_order_acquire);
+        if (before & 1) continue; // Publication in progress
+
+        out->count = current.count;
+        out->version = current.version;
+        const int count = out->count < 0 ? 0 : out->count > MAX_INSTANCES ? MAX_INSTANCES : out->count;
+        memcpy(out->entries, current.entries, sizeof(Task) * count);
+        memcpy(out->reservations, current.reservations, sizeof(out->reservations));
+
+        atomic_thread_fence(memory_order_acquire);
+        after = atomic_load_explicit(&sequence, memory_order_relaxed);
+    } while ((before & 1) || before != after);
+}
@@ -1,14 +1,26 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <pthread.h>
-#include <math.h>
 #include <string.h>
+#include <time.h>
+#include <sys/random.h>
 #include "supervisor.h"
 
+#include "admission.h"
+#include "aperiodic.h"
+#include "checkpoint.h"
 #include "event_queue.h"
+#include "metrics.h"
+#include "overhead.h"
+#include "trace.h"
+#include "profiler.h"
+#include "reply.h"
+#include "snapshot.h"
 #include "task_config.h"
 #include "task_runtime.h"
-#include "tcp_server.h"
+
+#define USEC_PER_MSEC 1000L
+#define NSEC_PER_MSEC 1000000.0
 
 void supervisor_init(Supervisor *supervisor) {
     printf("[Supervisor] Subsystem Initialized.\n");
@@ -17,91 +29,288 @@ void supervisor_init(Supervisor *supervisor) {
     event_queue_init(&supervisor->queue);
     supervisor->active_count = 0;
     pthread_mutex_init(&supervisor->active_mutex, NULL);
+    supervisor->admission.mode = ADMISSION_DECLARED;
+    supervisor->admission.wcet_margin = PROFILE_DEFAULT_MARGIN;
+    supervisor->admission.command_budget = CONTROL_COMMAND_BUDGET;
+    supervisor->admission.event_budget = CONTROL_EVENT_BUDGET;
+    memset(supervisor->admission.reservations, 0, sizeof(supervisor->admission.reservations));
+    snapshot_publish(supervisor->active_set, 0, supervisor->admission.reservations);
+    atomic_init(&supervisor->command_window.state, 0);
 }
 
-static int compare_deadline(const void *a, const void *b) {
-    const TaskType *ta = *(const TaskType **) a;
-    const TaskType *tb = *(const TaskType **) b;
-    return (int) (ta->deadline_ms - tb->deadline_ms);
+/*
+ * Admission test of the current active set plus an optional candidate under
+ * 'policy', the supervisor's own or a copy with changed reservations.
+ * @return 1 if schedulable, 0 otherwise.
+ */
+static int check_policy(Supervisor *supervisor, const AdmissionPolicy *policy, const Task *candidate,
+                        long *periods_ms) {
+    Task active[MAX_INSTANCES];
+    MetricCounter reason;
+
+    pthread_mutex_lock(&supervisor->active_mutex);
+    const int count = supervisor->active_count;
+    memcpy(active, supervisor->active_set, sizeof(Task) * count);
+    pthread_mutex_unlock(&supervisor->active_mutex);
+
+    if (admission_check(policy, active, count, candidate, periods_ms, &reason)) return 1;
+    metrics_inc(reason);
+    return 0;
 }
 
-static int check_rta(Supervisor *supervisor, const TaskType *candidate) {
-    const TaskType *tasks[MAX_INSTANCES + 1];
-    int count = 0;
+static int check_rta(Supervisor *supervisor, const Task *candidate, long *periods_ms) {
+    return check_policy(supervisor, &supervisor->admission, candidate, periods_ms);
+}
+
+/*
+ * Admission test of the instances of reservation 'slot' of 'policy' plus an
+ * optional candidate, against the reservation alone.
+ * @return 1 if schedulable, 0 otherwise.
+ */
+static int check_tenant(Supervisor *supervisor, const AdmissionPolicy *policy, const int slot,
+                        const Task *candidate) {
+    Task active[MAX_INSTANCES];
+    MetricCounter reason;
+    const Reservation *live = &supervisor->admission.reservations[slot];
+    const Reservation *res = &policy->reservations[slot];
 
     pthread_mutex_lock(&supervisor->active_mutex);
-    for (int i = 0; i < supervisor->active_count; i++) tasks[count++] = supervisor->active_set[i].type;
+    const int count = supervisor->active_count;
+    memcpy(active, supervisor->active_set, sizeof(Task) * count);
     pthread_mutex_unlock(&supervisor->active_mutex);
-    tasks[count++] = candidate;
+    // The members point into the live table: move them to the tested copy
+    for (int i = 0; i < count; i++) {
+        if (active[i].reservation == live) active[i].reservation = res;
+    }
+
+    if (admission_check_reservation(policy, res, active, count, candidate, &reason)) return 1;
+    metrics_inc(reason);
+    return 0;
+}
+
+/*
+ * Number of instances running in 'res'.
+ * Must be called with active_mutex held.
+ */
+static int reservation_members(const Supervisor *spv, const Reservation *res) {
+    int members = 0;
+    for (int i = 0; i < spv->active_count; i++) {
+        if (spv->active_set[i].reservation == res) members++;
+    }
+    return members;
+}
+
+static int reservation_slot(const Supervisor *spv, const Reservation *res) {
+    return res ? (int) (res - spv->admission.reservations) : -1;
+}
+
+/*
+ * Reservation of the client that sent 'ev', if its tenant name matches one
+ * and its token hashes to the one stored. Admin clients do not need the token.
+ * @return The reservation, NULL if there is none or the token is wrong.
+ */
+static const Reservation *resolve_tenant(const Supervisor *spv, const Event *ev) {
+    uint8_t hash[SHA256_DIGEST_LEN];
+    const Reservation *res = admission_find_reservation(&spv->admission, ev->tenant);
+    if (!res || ev->admin) return res;
+    sha256(ev->token, strnlen(ev->token, ACCESS_TOKEN_LEN), hash);
+    return sha256_equal(res->token_hash, hash) ? res : NULL;
+}
+
+/*
+ * Saves the active set with the upcoming release of every instance.
+ * Must be called with active_mutex held.
+ */
+static void save_checkpoint(const Supervisor *spv) {
+    static CheckpointState state; // Supervisor only
+    long long epoch_ns;
+    int next_id;
+
+    runtime_resume_point(&epoch_ns, &next_id);
+    state.epoch_realtime_ns = epoch_ns;
+    state.next_id = next_id;
+    state.count = spv->active_count;
+    for (int r = 0; r < MAX_RESERVATIONS; r++) {
+        const Reservation *res = &spv->admission.reservations[r];
+        CheckpointReservation *c = &state.reservations[r];
+        memset(c, 0, sizeof(*c));
+        memcpy(c->name, res->name, sizeof(c->name));
+        memcpy(c->token_hash, res->token_hash, sizeof(c->token_hash));
+        c->budget_ms = res->budget_ms;
+        c->period_ms = res->period_ms;
+        c->max_instances = res->max_instances;
+    }
+    for (int i = 0; i < spv->active_count; i++) {
+        const Task *t = &spv->active_set[i];
+        CheckpointEntry *e = &state.entries[i];
+        memset(e->task_name, 0, sizeof(e->task_name));
+        strncpy(e->task_name, t->type->name, sizeof(e->task_name) - 1);
+        e->instance_id = t->instance_id;
+        e->reservation = reservation_slot(spv, t->reservation);
+        e->offset_ms = t->offset_ms;
+        e->period_ms = t->period_ms;
+        e->anchor_ns = runtime_next_release_ns(t->instance_id);
+    }
+    checkpoint_save(&state);
+}
 
-    // Utilization Test (Necessary Condition)
+/*
+ * Publishes the active set snapshot read by LIST and INFO, its size, the
+ * reservations and the utilization admitted at the top level (shared pool
+ * instances and reservation budgets), and checkpoints it.
+ * Must be called with active_mutex held.
+ */
+static void publish_active_set(const Supervisor *spv) {
     double util = 0;
-    for (int i = 0; i < count; i++) {
-        util += (double) tasks[i]->wcet_ms / (double) tasks[i]->period_ms;
+    int reservations = 0;
+    for (int i = 0; i < spv->active_count; i++) {
+        if (spv->active_set[i].reservation) continue;
+        util += (double) admission_task_wcet_us(&spv->admission, &spv->active_set[i]) /
+                (double) (spv->active_set[i].period_ms * USEC_PER_MSEC);
     }
-    if (util > 1.0) {
-        printf("[RTA] Rejected %s: Utilization %.2f > 1.0\n", candidate->name, util);
-        return 0;
+    for (int r = 0; r < MAX_RESERVATIONS; r++) {
+        const Reservation *res = &spv->admission.reservations[r];
+        if (res->name[0] == '\0') continue;
+        util += (double) res->budget_ms / (double) res->period_ms;
+        reservations++;
     }
+    metrics_gauge_set(GAUGE_RESERVATIONS, reservations);
+    metrics_gauge_set(GAUGE_ACTIVE_INSTANCES, spv->active_count);
+    metrics_gauge_set(GAUGE_ADMITTED_UTILIZATION_PPM, (long long) (util * 1e6));
+    snapshot_publish(spv->active_set, spv->active_count, spv->admission.reservations);
+    if (checkpoint_enabled()) save_checkpoint(spv);
+}
 
-    // Response Time Analysis (Sufficient Condition)
-    qsort(tasks, count, sizeof(const TaskType *), compare_deadline);
+/*
+ * Re-applies the deadline-monotonic ranks to the running threads and the
+ * aperiodic server, for the active set plus an optional candidate about to
+ * start: admission assumes distinct priorities in that order.
+ * Must be called with active_mutex held.
+ * @return The candidate's priority, 0 without a candidate.
+ */
+static int rank_priorities(Supervisor *spv, const Task *candidate) {
+    Task set[MAX_INSTANCES + 1];
+    int priorities[MAX_INSTANCES + 1];
+    const int count = spv->active_count;
 
+    memcpy(set, spv->active_set, sizeof(Task) * count);
+    if (candidate) set[count] = *candidate;
+    const int server_priority = admission_priorities(&spv->admission, set, count + (candidate ? 1 : 0), priorities);
+    aperiodic_set_priority(server_priority);
     for (int i = 0; i < count; i++) {
-        double R = (double) tasks[i]->wcet_ms;
-        int converged = 0;
+        Task *t = &spv->active_set[i];
+        if (t->priority == priorities[i]) continue;
+        t->priority = priorities[i];
+        runtime_set_priority(t->instance_id, t->priority);
+    }
+    return candidate ? priorities[count] : 0;
+}
 
-        for (int k = 0; k < 100; k++) {
-            double I = 0;
-            for (int j = 0; j < i; j++) {
-                I += ceil(R / (double) tasks[j]->period_ms) * (double) tasks[j]->wcet_ms;
-            }
-            const double R_new = (double) tasks[i]->wcet_ms + I;
+/*
+ * Applies the assigned periods to the running instances.
+ * They take effect at each instance's next release.
+ */
+static void apply_periods(Supervisor *spv, const long *periods_ms) {
+    pthread_mutex_lock(&spv->active_mutex);
+    for (int i = 0; i < spv->active_count; i++) {
+        Task *t = &spv->active_set[i];
+        if (t->period_ms == periods_ms[i]) continue;
+        printf("[Supervisor] ID %d period %ld -> %ld ms\n", t->instance_id, t->period_ms, periods_ms[i]);
+        t->period_ms = periods_ms[i];
+        runtime_set_period(t->instance_id, periods_ms[i]);
+    }
+    publish_active_set(spv);
+    pthread_mutex_unlock(&spv->active_mutex);
+}
 
-            if (R_new > (double) tasks[i]->deadline_ms) {
-                printf("[RTA] Rejected %s: R=%.1f > D=%ld\n", candidate->name, R_new, tasks[i]->deadline_ms);
-                return 0;
-            }
-            if (R_new == R) {
-                converged = 1;
-                break;
-            }
-            R = R_new;
-        }
-        if (!converged) return 0;
+/*
+ * Expands compressed periods back toward nominal after the load dropped.
+ * @return 1 if periods were applied, and so the set published, 0 otherwise.
+ */
+static int rebalance_periods(Supervisor *spv) {
+    long periods_ms[MAX_ANALYSIS_TASKS];
+    int compressed = 0;
+
+    pthread_mutex_lock(&spv->active_mutex);
+    for (int i = 0; i < spv->active_count; i++) {
+        if (spv->active_set[i].period_ms != spv->active_set[i].type->period_ms) compressed = 1;
     }
+    pthread_mutex_unlock(&spv->active_mutex);
+
+    if (!compressed || !check_rta(spv, NULL, periods_ms)) return 0;
+    apply_periods(spv, periods_ms);
     return 1;
 }
 
+static void trace_supervisor(const TraceEventType type, const TaskType *task, const int id) {
+    const int index = task ? (int) (task - tasks_config.tasks) : -1;
+    trace_record(TRACE_RING_SUPERVISOR, type, index, id, 0, trace_now());
+}
+
 static void handle_activate(Supervisor *spv, const Event ev) {
-    char resp[64];
-    const TaskType *task = tasks_config_get_by_name(&tasks_config, ev.payload.task_name);
+    EventStatus status;
+    long periods_ms[MAX_ANALYSIS_TASKS];
+    const TaskType *task = tasks_config_get_by_name(&tasks_config, ev.payload.activate.task_name);
+    const long offset_ms = ev.payload.activate.offset_ms;
     Task *active_set = spv->active_set;
     pthread_mutex_t *active_mutex = &spv->active_mutex;
     const int active_count = spv->active_count;
+    const Reservation *res = NULL;
 
     if (!task) {
-        tcp_server_send_response(ev.client_fd, "ERR Unknown Task\n");
+        metrics_inc(METRIC_REJECT_UNKNOWN);
+        trace_supervisor(TRACE_REJECT, NULL, -1);
+        reply_status(&ev, STATUS_ERR_UNKNOWN_TASK, 0);
         return;
     }
+    if (ev.tenant[0] != '\0') {
+        res = resolve_tenant(spv, &ev);
+        if (!res) {
+            metrics_inc(METRIC_REJECT_UNKNOWN);
+            trace_supervisor(TRACE_REJECT, task, -1);
+            reply_status(&ev, STATUS_ERR_UNKNOWN_RESERVATION, 0);
+            return;
+        }
+    }
 
-    if (!check_rta(spv, task)) {
-        tcp_server_send_response(ev.client_fd, "ERR Schedulability\n");
+    // C_LO is fixed here: the instance is analysed and enforced with it whatever the profiler learns later
+    Task candidate = {
+        .type = task, .instance_id = -1, .offset_ms = offset_ms, .reservation = res,
+        .wcet_us = admission_wcet_us(&spv->admission, task)
+    };
+    // A tenant's task only has to fit its reservation
+    if (res ? !check_tenant(spv, &spv->admission, reservation_slot(spv, res), &candidate)
+            : !check_rta(spv, &candidate, periods_ms)) {
+        trace_supervisor(TRACE_REJECT, task, -1);
+        reply_status(&ev, STATUS_ERR_SCHEDULABILITY, 0);
         return;
     }
 
     // Pre-check capacity to avoid unnecessary thread spawning
     pthread_mutex_lock(active_mutex);
-    if (active_count >= MAX_INSTANCES) {
+    if (active_count >= MAX_INSTANCES || (res && reservation_members(spv, res) >= res->max_instances)) {
         pthread_mutex_unlock(active_mutex);
-        tcp_server_send_response(ev.client_fd, "ERR System Full\n");
+        metrics_inc(METRIC_REJECT_FULL);
+        trace_supervisor(TRACE_REJECT, task, -1);
+        reply_status(&ev, STATUS_ERR_SYSTEM_FULL, 0);
         return;
     }
     pthread_mutex_unlock(active_mutex);
 
-    const int id = runtime_create_instance(task);
+    // Compress the running instances first: the new one must not release a job next to the uncompressed set
+    if (!res) apply_periods(spv, periods_ms);
+    const long period_ms = res ? task->period_ms : periods_ms[active_count];
+    candidate.period_ms = period_ms;
+    pthread_mutex_lock(active_mutex);
+    const int priority = rank_priorities(spv, &candidate);
+    pthread_mutex_unlock(active_mutex);
+    const int id = runtime_create_instance(task, offset_ms, period_ms, reservation_slot(spv, res), priority,
+                                           candidate.wcet_us);
     if (id < 0) {
-        tcp_server_send_response(ev.client_fd, "ERR System Full\n");
+        if (!res) rebalance_periods(spv); // Compressed for an instance that never started
+        metrics_inc(METRIC_REJECT_FULL);
+        trace_supervisor(TRACE_REJECT, task, -1);
+        reply_status(&ev, STATUS_ERR_SYSTEM_FULL, 0);
         return;
     }
 
@@ -109,17 +318,339 @@ static void handle_activate(Supervisor *spv, const Event ev) {
     if (active_count < MAX_INSTANCES) {
         active_set[active_count].type = task;
         active_set[active_count].instance_id = id;
+        active_set[active_count].offset_ms = offset_ms;
+        active_set[active_count].period_ms = period_ms;
+        active_set[active_count].reservation = res;
+        active_set[active_count].priority = priority;
+        active_set[active_count].wcet_us = candidate.wcet_us;
         spv->active_count++;
-        snprintf(resp, sizeof(resp), "OK ID=%d\n", id);
-        printf("[Supervisor] Activated task '%s' as ID %d (Total: %d)\n", task->name, id, active_count);
+        publish_active_set(spv);
+        metrics_inc(METRIC_ADMISSIONS);
+        trace_supervisor(TRACE_ADMIT, task, id);
+        status = STATUS_OK;
+        printf("[Supervisor] Activated task '%s' as ID %d%s%s (Total: %d)\n", task->name, id,
+               res ? " in reservation " : "", res ? res->name : "", active_count);
     } else {
         // Safe fallback in case of race condition
         runtime_stop_instance(id);
-        snprintf(resp, sizeof(resp), "ERR System Full\n");
+        metrics_inc(METRIC_REJECT_FULL);
+        trace_supervisor(TRACE_REJECT, task, -1);
+        status = STATUS_ERR_SYSTEM_FULL;
     }
     pthread_mutex_unlock(active_mutex);
 
-    tcp_server_send_response(ev.client_fd, resp);
+    if (status != STATUS_OK && !res) rebalance_periods(spv);
+    reply_status(&ev, status, status == STATUS_OK ? id : 0);
+}
+
+/*
+ * Fills 'token' with a new random tenant token, 32 hex digits, and 'hash'
+ * with the digest the supervisor keeps in its place.
+ * @return 0 on success, -1 if the kernel has no randomness to give.
+ */
+static int issue_token(char token[ACCESS_TOKEN_LEN], uint8_t hash[SHA256_DIGEST_LEN]) {
+    unsigned char bytes[(ACCESS_TOKEN_LEN - 1) / 2];
+    if (getrandom(bytes, sizeof(bytes), 0) != (ssize_t) sizeof(bytes)) return -1;
+    for (size_t i = 0; i < sizeof(bytes); i++) snprintf(token + 2 * i, 3, "%02x", bytes[i]);
+    sha256(token, ACCESS_TOKEN_LEN - 1, hash);
+    return 0;
+}
+
+/*
+ * Creates a reservation or resizes an existing one. The top level must pass
+ * with the new budget, and a resized reservation must still fit its members.
+ * Both are tested on a copy of the policy: the table only changes once the
+ * reservation is admitted, and readers see it through the next snapshot.
+ * Admin only. A new reservation's reply carries the token tenants bind with,
+ * the only time it is shown; a resize keeps it and replies a plain OK.
+ */
+static void handle_reserve(Supervisor *spv, const Event ev) {
+    long periods_ms[MAX_ANALYSIS_TASKS];
+    char token[ACCESS_TOKEN_LEN];
+    char resp[64];
+    AdmissionPolicy policy = spv->admission;
+    int slot = reservation_slot(spv, admission_find_reservation(&spv->admission, ev.payload.reserve.name));
+    const bool resize = slot >= 0;
+
+    if (!ev.admin) {
+        reply_status(&ev, STATUS_ERR_PERMISSION_DENIED, 0);
+        return;
+    }
+    if (spv->admission.cyclic) {
+        // The executive runs every job at one priority: there is nothing to throttle
+        reply_status(&ev, STATUS_ERR_INVALID_COMMAND, 0);
+        return;
+    }
+    for (int r = 0; slot < 0 && r < MAX_RESERVATIONS; r++) {
+        if (policy.reservations[r].name[0] == '\0') slot = r;
+    }
+    if (slot < 0) {
+        metrics_inc(METRIC_REJECT_FULL);
+        reply_status(&ev, STATUS_ERR_SYSTEM_FULL, 0);
+        return;
+    }
+
+    pthread_mutex_lock(&spv->active_mutex);
+    const int members = reservation_members(spv, &spv->admission.reservations[slot]);
+    pthread_mutex_unlock(&spv->active_mutex);
+    if (members > ev.payload.reserve.max_instances) {
+        metrics_inc(METRIC_REJECT_FULL);
+        reply_status(&ev, STATUS_ERR_SYSTEM_FULL, 0);
+        return;
+    }
+
+    Reservation *res = &policy.reservations[slot];
+    memcpy(res->name, ev.payload.reserve.name, sizeof(res->name));
+    res->budget_ms = ev.payload.reserve.budget_ms;
+    res->period_ms = ev.payload.reserve.period_ms;
+    res->max_instances = ev.payload.reserve.max_instances;
+    if (!resize && issue_token(token, res->token_hash) != 0) {
+        reply_status(&ev, STATUS_ERR_SYSTEM_BUSY, 0);
+        return;
+    }
+    if (!check_policy(spv, &policy, NULL, periods_ms) || (resize && !check_tenant(spv, &policy, slot, NULL))) {
+        reply_status(&ev, STATUS_ERR_SCHEDULABILITY, 0);
+        return;
+    }
+
+    pthread_mutex_lock(&spv->active_mutex);
+    spv->admission.reservations[slot] = *res;
+    pthread_mutex_unlock(&spv->active_mutex);
+    runtime_reserve(slot, res->budget_ms, res->period_ms);
+    apply_periods(spv, periods_ms); // Publishes the table
+    pthread_mutex_lock(&spv->active_mutex);
+    rank_priorities(spv, NULL); // The reservation's deadline is its period
+    pthread_mutex_unlock(&spv->active_mutex);
+    printf("[Supervisor] Reservation '%s': %ld ms every %ld ms, up to %d instances\n",
+           res->name, res->budget_ms, res->period_ms, res->max_instances);
+    if (resize) {
+        reply_status(&ev, STATUS_OK, 0);
+        return;
+    }
+    snprintf(resp, sizeof(resp), "OK TOKEN=%s\n", token);
+    reply_text(&ev, STATUS_OK, resp, true, true);
+}
+
+/*
+ * Deletes a reservation that has no instances left. Its budget returns to
+ * the shared pool, whose compressed periods can expand again. Admin only.
+ */
+static void handle_unreserve(Supervisor *spv, const Event ev) {
+    const int slot = reservation_slot(spv, admission_find_reservation(&spv->admission, ev.payload.unreserve.name));
+
+    if (!ev.admin) {
+        reply_status(&ev, STATUS_ERR_PERMISSION_DENIED, 0);
+        return;
+    }
+    if (slot < 0) {
+        reply_status(&ev, STATUS_ERR_UNKNOWN_RESERVATION, 0);
+        return;
+    }
+    pthread_mutex_lock(&spv->active_mutex);
+    if (reservation_members(spv, &spv->admission.reservations[slot]) > 0) {
+        pthread_mutex_unlock(&spv->active_mutex);
+        reply_status(&ev, STATUS_ERR_RESERVATION_IN_USE, 0);
+        return;
+    }
+    memset(&spv->admission.reservations[slot], 0, sizeof(Reservation));
+    rank_priorities(spv, NULL);
+    pthread_mutex_unlock(&spv->active_mutex);
+
+    // Published once, with the expanded periods if any
+    if (!rebalance_periods(spv)) {
+        pthread_mutex_lock(&spv->active_mutex);
+        publish_active_set(spv);
+        pthread_mutex_unlock(&spv->active_mutex);
+    }
+    printf("[Supervisor] Reservation '%s' deleted\n", ev.payload.unreserve.name);
+    reply_status(&ev, STATUS_OK, 0);
+}
+
+/*
+ * Starts one restored instance, admitted with C_LO 'wcet_us', and appends it to the active set.
+ * @return 1 if it runs, 0 otherwise.
+ */
+static int restore_entry(Supervisor *spv, const TaskType *type, const CheckpointEntry *e, const long period_ms,
+                         const Reservation *res, const long long wcet_us) {
+    Task task = {
+        .type = type, .instance_id = e->instance_id, .offset_ms = (long) e->offset_ms, .period_ms = period_ms,
+        .reservation = res, .wcet_us = wcet_us
+    };
+    pthread_mutex_lock(&spv->active_mutex);
+    task.priority = rank_priorities(spv, &task);
+    pthread_mutex_unlock(&spv->active_mutex);
+    const int id = runtime_restore_instance(type, e->instance_id, (long) e->offset_ms, period_ms, e->anchor_ns,
+                                            reservation_slot(spv, res), task.priority, task.wcet_us);
+    if (id < 0) {
+        printf("[Checkpoint] Could not restart ID %d (%s)\n", e->instance_id, type->name);
+        return 0;
+    }
+    pthread_mutex_lock(&spv->active_mutex);
+    spv->active_set[spv->active_count++] = task;
+    pthread_mutex_unlock(&spv->active_mutex);
+    trace_supervisor(TRACE_ADMIT, type, id);
+    return 1;
+}
+
+/*
+ * Re-creates the saved reservations, each tested at the top level against
+ * the ones before it. They come before the instances: the shared pool has
+ * to fit around the tenants' budgets.
+ */
+static void restore_reservations(Supervisor *spv, const CheckpointState *state) {
+    long periods_ms[MAX_ANALYSIS_TASKS];
+
+    for (int r = 0; r < MAX_RESERVATIONS; r++) {
+        const CheckpointReservation *c = &state->reservations[r];
+        Reservation *res = &spv->admission.reservations[r];
+        if (c->name[0] == '\0') continue;
+        memcpy(res->name, c->name, sizeof(res->name));
+        res->name[TASK_NAME_LEN - 1] = '\0';
+        memcpy(res->token_hash, c->token_hash, sizeof(res->token_hash));
+        res->budget_ms = (long) c->budget_ms;
+        res->period_ms = (long) c->period_ms;
+        res->max_instances = c->max_instances;
+        if (res->budget_ms <= 0 || res->budget_ms > res->period_ms || !check_rta(spv, NULL, periods_ms)) {
+            printf("[Checkpoint] Dropped reservation '%s': no longer schedulable\n", res->name);
+            memset(res, 0, sizeof(*res));
+            continue;
+        }
+        runtime_reserve(r, res->budget_ms, res->period_ms);
+    }
+}
+
+/*
+ * Tests every reservation against its members in the active set.
+ * @return 1 if all fit, 0 otherwise.
+ */
+static int check_tenants(Supervisor *spv) {
+    for (int r = 0; r < MAX_RESERVATIONS; r++) {
+        const Reservation *res = &spv->admission.reservations[r];
+        if (res->name[0] != '\0' && !check_tenant(spv, &spv->admission, r, NULL)) return 0;
+    }
+    return 1;
+}
+
+int supervisor_restore(Supervisor *spv, const CheckpointState *state) {
+    const TaskType *types[MAX_INSTANCES];
+    const CheckpointEntry *entries[MAX_INSTANCES];
+    const Reservation *owners[MAX_INSTANCES];
+    long long wcets_us[MAX_INSTANCES];
+    long periods_ms[MAX_ANALYSIS_TASKS];
+    struct timespec start, end;
+    int count = 0;
+    int restored = 0;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if (runtime_resume(state->epoch_realtime_ns, state->next_id) != 0) {
+        printf("[Checkpoint] Saved epoch is from another boot, releases restart on a fresh grid\n");
+    }
+    restore_reservations(spv, state);
+
+    // The whole saved set goes through a single admission test
+    pthread_mutex_lock(&spv->active_mutex);
+    for (int i = 0; i < state->count; i++) {
+        const CheckpointEntry *e = &state->entries[i];
+        const TaskType *type = tasks_config_get_by_name(&tasks_config, e->task_name);
+        if (!type) {
+            printf("[Checkpoint] Dropped ID %d: unknown task '%.*s'\n", e->instance_id, TASK_NAME_LEN, e->task_name);
+            continue;
+        }
+        const Reservation *res = NULL;
+        if (e->reservation >= 0) {
+            if (e->reservation < MAX_RESERVATIONS && spv->admission.reservations[e->reservation].name[0] != '\0') {
+                res = &spv->admission.reservations[e->reservation];
+            } else {
+                printf("[Checkpoint] Dropped ID %d (%s): its reservation is gone\n", e->instance_id, type->name);
+                continue;
+            }
+        }
+        types[count] = type;
+        entries[count] = e;
+        owners[count] = res;
+        wcets_us[count] = admission_wcet_us(&spv->admission, type);
+        spv->active_set[count] = (Task){
+            .type = type, .instance_id = e->instance_id, .offset_ms = (long) e->offset_ms, .period_ms = type->period_ms,
+            .reservation = res, .wcet_us = wcets_us[count]
+        };
+        count++;
+    }
+    spv->active_count = count;
+    pthread_mutex_unlock(&spv->active_mutex);
+
+    const bool bulk = count > 0 && check_rta(spv, NULL, periods_ms) && check_tenants(spv);
+    pthread_mutex_lock(&spv->active_mutex);
+    spv->active_count = 0;
+    pthread_mutex_unlock(&spv->active_mutex);
+
+    if (bulk) {
+        for (int i = 0; i < count; i++) {
+            restored += restore_entry(spv, types[i], entries[i], periods_ms[i], owners[i], wcets_us[i]);
+        }
+    } else {
+        // The catalog or the host changed: keep the longest schedulable prefix, one by one
+        for (int i = 0; i < count; i++) {
+            const Reservation *res = owners[i];
+            if (res) {
+                pthread_mutex_lock(&spv->active_mutex);
+                const bool room = reservation_members(spv, res) < res->max_instances;
+                pthread_mutex_unlock(&spv->active_mutex);
+                const Task candidate = {.type = types[i], .instance_id = -1, .reservation = res, .wcet_us = wcets_us[i]};
+                if (!room || !check_tenant(spv, &spv->admission, reservation_slot(spv, res), &candidate)) {
+                    printf("[Checkpoint] Dropped ID %d (%s): no longer fits reservation %s\n",
+                           entries[i]->instance_id, types[i]->name, res->name);
+                    continue;
+                }
+                restored += restore_entry(spv, types[i], entries[i], types[i]->period_ms, res, wcets_us[i]);
+                continue;
+            }
+            const Task candidate = {
+                .type = types[i], .instance_id = -1, .offset_ms = (long) entries[i]->offset_ms, .wcet_us = wcets_us[i]
+            };
+            if (!check_rta(spv, &candidate, periods_ms)) {
+                printf("[Checkpoint] Dropped ID %d (%s): no longer schedulable\n", entries[i]->instance_id, types[i]->name);
+                continue;
+            }
+            const int n = spv->active_count;
+            apply_periods(spv, periods_ms); // Like ACTIVATE: compress before the entry starts
+            if (restore_entry(spv, types[i], entries[i], periods_ms[n], NULL, wcets_us[i])) restored++;
+            else rebalance_periods(spv);
+        }
+    }
+
+    pthread_mutex_lock(&spv->active_mutex);
+    rank_priorities(spv, NULL); // Closes the levels of the dropped entries
+    publish_active_set(spv);
+    pthread_mutex_unlock(&spv->active_mutex);
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    printf("[Checkpoint] Restored %d/%d instances in %.2f ms (%s)\n", restored, state->count,
+           (double) ((end.tv_sec - start.tv_sec) * 1000000000LL + (end.tv_nsec - start.tv_nsec)) / NSEC_PER_MSEC,
+           bulk ? "bulk admission" : "incremental admission");
+    return restored;
+}
+
+static void handle_submit(const Event ev) {
+    const TaskType *task = tasks_config_get_by_name(&tasks_config, ev.payload.submit.task_name);
+    EventStatus status = STATUS_OK;
+    long job = 0;
+
+    if (!aperiodic_enabled()) {
+        status = STATUS_ERR_NO_APERIODIC_SERVER;
+    } else if (!task) {
+        status = STATUS_ERR_UNKNOWN_TASK;
+    } else {
+        AperiodicStats st;
+        aperiodic_get_stats(&st);
+        if (task_wcet_ms(task, CRIT_HI) > st.budget_ms) {
+            status = STATUS_ERR_EXCEEDS_SERVER_BUDGET;
+        } else {
+            job = aperiodic_submit(task);
+            if (job < 0) status = STATUS_ERR_SERVER_QUEUE_FULL;
+        }
+    }
+    metrics_inc(status == STATUS_OK ? METRIC_APERIODIC_SUBMITTED : METRIC_APERIODIC_REJECTED);
+    reply_status(&ev, status, job);
 }
 
 static void handle_deactivate(Supervisor *spv, const Event ev) {
@@ -129,8 +660,27 @@ static void handle_deactivate(Supervisor *spv, const Event ev) {
 
     const int id = (int) ev.payload.target_id;
 
+    // A tenant can only stop its own instances, an unbound client the shared pool's, an admin any
+    if (ev.tenant[0] != '\0' || !ev.admin) {
+        const Reservation *res = NULL;
+        bool own = false;
+        if (ev.tenant[0] != '\0' && !(res = resolve_tenant(spv, &ev))) {
+            reply_status(&ev, STATUS_ERR_UNKNOWN_RESERVATION, 0);
+            return;
+        }
+        pthread_mutex_lock(active_mutex);
+        for (int i = 0; i < active_count; i++) {
+            if (active_set[i].instance_id == id && active_set[i].reservation == res) own = true;
+        }
+        pthread_mutex_unlock(active_mutex);
+        if (!own) {
+            reply_status(&ev, STATUS_ERR_INVALID_ID, 0);
+            return;
+        }
+    }
+
     if (runtime_stop_instance(id) != 0) {
-        tcp_server_send_response(ev.client_fd, "ERR Invalid ID\n");
+        reply_status(&ev, STATUS_ERR_INVALID_ID, 0);
         return;
     }
 
@@ -145,61 +695,190 @@ static void handle_deactivate(Supervisor *spv, const Event ev) {
     if (idx != -1) {
         for (int i = idx; i < active_count - 1; i++) active_set[i] = active_set[i + 1];
         spv->active_count--;
+        rank_priorities(spv, NULL);
     }
     pthread_mutex_unlock(active_mutex);
 
-    tcp_server_send_response(ev.client_fd, "OK\n");
+    // Published once, with the expanded periods if any: readers never see the interim set
+    if (!rebalance_periods(spv)) {
+        pthread_mutex_lock(active_mutex);
+        publish_active_set(spv);
+        pthread_mutex_unlock(active_mutex);
+    }
+    metrics_inc(METRIC_DEACTIVATIONS);
+    trace_supervisor(TRACE_DEACTIVATE, NULL, id);
+    reply_status(&ev, STATUS_OK, 0);
     printf("[Supervisor] Deactivated task ID %d\n", id);
 }
 
-static void handle_list(Supervisor *spv, const Event ev) {
-    const Task *active_set = spv->active_set;
-    pthread_mutex_t *active_mutex = &spv->active_mutex;
-    const int active_count = spv->active_count;
-
-    char resp[NET_RESPONSE_BUF_SIZE];
+void supervisor_serve_list(const Supervisor *spv, const Event ev) {
+    static _Thread_local ActiveSnapshot snap; // One per transport thread
+    char resp[NET_RESPONSE_BUF_SIZE - 16];
     int off = 0;
-    pthread_mutex_lock(active_mutex);
-    off += snprintf(resp + off, sizeof(resp) - off, "Running: %d\n", active_count);
-    for (int i = 0; i < active_count; i++) {
-        if (sizeof(resp) - off < 100) break;
-        off += snprintf(resp + off, sizeof(resp) - off, "  [ID %d] %s (C=%ld, T=%ld)\n",
-                        active_set[i].instance_id, active_set[i].type->name,
-                        active_set[i].type->wcet_ms, active_set[i].type->period_ms);
+    bool first = true;
+
+    snapshot_read(&snap);
+    // Clamped before adding: both come from the client and may be near LONG_MAX
+    const long start = ev.payload.list.offset < snap.count ? ev.payload.list.offset : snap.count;
+    const long end = (ev.payload.list.limit > 0 && ev.payload.list.limit < snap.count - start)
+                         ? start + ev.payload.list.limit
+                         : snap.count;
+
+    off += snprintf(resp + off, sizeof(resp) - off, "Running: %d (version %lu)\n", snap.count, snap.version);
+    long i = start;
+    for (; i < end; i++) {
+        if (sizeof(resp) - off < 100) {
+            // A shared-memory reply is one slot: end the page there, as a limit would
+            if (ev.channel == REPLY_SHM) break;
+            // Stream in chunks instead of truncating large sets
+            reply_text(&ev, STATUS_OK, resp, first, false);
+            first = false;
+            off = 0;
+        }
+        const Task *t = &snap.entries[i];
+        off += snprintf(resp + off, sizeof(resp) - off, "  [ID %d] %s (C=%ld, T=%ld, O=%ld)",
+                        t->instance_id, t->type->name, t->type->wcet_ms, t->period_ms, t->offset_ms);
+        if (t->reservation) {
+            off += snprintf(resp + off, sizeof(resp) - off, " in %s",
+                            snap.reservations[reservation_slot(spv, t->reservation)].name);
+        }
+        off += snprintf(resp + off, sizeof(resp) - off, "\n");
     }
-    pthread_mutex_unlock(active_mutex);
-    tcp_server_send_response(ev.client_fd, resp);
+    if (i < snap.count) {
+        off += snprintf(resp + off, sizeof(resp) - off, "  ... %ld more, next offset %ld\n", snap.count - i, i);
+    }
+    reply_text(&ev, STATUS_OK, resp, first, true);
 }
 
-static void handle_info(const Supervisor *spv, const Event ev) {
-    char resp[NET_RESPONSE_BUF_SIZE];
+void supervisor_serve_info(const Supervisor *spv, const Event ev) {
+    static _Thread_local ActiveSnapshot snap; // One per transport thread
+    char resp[NET_RESPONSE_BUF_SIZE - 16];
     int off = 0;
     const TaskType *cat = tasks_config.tasks;
+
+    snapshot_read(&snap);
     off += snprintf(resp + off, sizeof(resp) - off,
-                    "Capacity: %d/%d active\nTasks:\n",
-                    spv->active_count,
-                    MAX_INSTANCES);
+                    "Capacity: %d/%d active\nAdmission: %s (margin %.2f)\nCriticality: %s mode\nTasks:\n",
+                    snap.count,
+                    MAX_INSTANCES,
+                    spv->admission.mode == ADMISSION_MEASURED ? "measured" : "declared",
+                    spv->admission.wcet_margin,
+                    runtime_criticality_mode() == CRIT_HI ? "HI" : "LO");
     for (int i = 0; i < N_TASKS; i++) {
-        off += snprintf(resp + off, sizeof(resp) - off, "  %s: C=%ld T=%ld D=%ld\n",
+        WcetProfile p;
+        profiler_get(i, &p);
+        off += snprintf(resp + off, sizeof(resp) - off, "  %s: C=%ld T=%ld D=%ld",
                         cat[i].name, cat[i].wcet_ms, cat[i].period_ms, cat[i].deadline_ms);
+        if (cat[i].criticality == CRIT_HI) {
+            off += snprintf(resp + off, sizeof(resp) - off, " HI C_HI=%ld", cat[i].wcet_hi_ms);
+        }
+        off += snprintf(resp + off, sizeof(resp) - off, " | observed n=%llu max=%.2f p99=%.2f",
+                        p.samples, p.max_ms, p.p99_ms);
+        if (p.overruns > 0) off += snprintf(resp + off, sizeof(resp) - off, " overruns=%llu", p.overruns);
+        if (p.evt_ms >= 0) off += snprintf(resp + off, sizeof(resp) - off, " evt=%.2f\n", p.evt_ms);
+        else off += snprintf(resp + off, sizeof(resp) - off, " evt=n/a\n");
+    }
+    const AdmissionPolicy *pol = &spv->admission;
+    off += snprintf(resp + off, sizeof(resp) - off,
+                    "Overhead: job +%lld us (release %lld, switch %lld) | control %s: %d cmd x %lld us, %d ev x %lld us per %d ms\n",
+                    overhead_job_us(&pol->overhead), pol->overhead.release_us, pol->overhead.context_switch_us,
+                    pol->control_on_task_cpu ? "on task core" : "isolated",
+                    pol->command_budget, pol->overhead.command_us, pol->event_budget, pol->overhead.event_us,
+                    CONTROL_INTERVAL_MS);
+    if (aperiodic_enabled()) {
+        AperiodicStats st;
+        aperiodic_get_stats(&st);
+        off += snprintf(resp + off, sizeof(resp) - off,
+                        "Aperiodic server: C=%ld T=%ld | submitted=%llu done=%llu queued=%d resp max=%.2f avg=%.2f\n",
+                        st.budget_ms, st.period_ms, st.submitted, st.completed, st.queued,
+                        st.max_response_ms, st.avg_response_ms);
+    }
+    for (int r = 0; r < MAX_RESERVATIONS; r++) {
+        const Reservation *res = &snap.reservations[r];
+        if (res->name[0] == '\0') continue;
+        int members = 0;
+        for (int i = 0; i < snap.count; i++) {
+            if (snap.entries[i].reservation == &pol->reservations[r]) members++;
+        }
+        off += snprintf(resp + off, sizeof(resp) - off, "Reservation %s: C=%ld T=%ld | %d/%d instances\n",
+                        res->name, res->budget_ms, res->period_ms, members, res->max_instances);
+    }
+    reply_text(&ev, STATUS_OK, resp, true, true);
+}
+
+static void handle_trace(const Event ev) {
+    char resp[128];
+    EventStatus status = STATUS_OK;
+    switch (ev.payload.trace.action) {
+        case TRACE_ACTION_START:
+            trace_start();
+            snprintf(resp, sizeof(resp), "OK Tracing\n");
+            break;
+        case TRACE_ACTION_STOP:
+            trace_stop();
+            snprintf(resp, sizeof(resp), "OK Trace Stopped\n");
+            break;
+        case TRACE_ACTION_DUMP: {
+            const long n = trace_dump(ev.payload.trace.file);
+            if (n < 0) status = STATUS_ERR_TRACE_DUMP;
+            else snprintf(resp, sizeof(resp), "OK %ld records\n", n);
+            break;
+        }
+        default:
+            status = STATUS_ERR_INVALID_COMMAND;
+            break;
+    }
+    if (status == STATUS_OK) reply_text(&ev, status, resp, true, true);
+    else reply_status(&ev, status, 0);
+}
+
+void supervisor_dispatch(Supervisor *spv, const Event ev) {
+    // Served on the calling thread: reads never wait on the supervisor or its locks
+    if (ev.type == EV_METRICS) {
+        char resp[NET_RESPONSE_BUF_SIZE - 16];
+        metrics_format(resp, sizeof(resp));
+        reply_text(&ev, STATUS_OK, resp, true, true);
+        return;
+    }
+    if (ev.type == EV_LIST) {
+        supervisor_serve_list(spv, ev);
+        return;
+    }
+    if (ev.type == EV_INFO) {
+        supervisor_serve_info(spv, ev);
+        return;
+    }
+
+    // Push to supervisor queue. If full, reject immediately to prevent timeout.
+    if (event_queue_push(&spv->queue, ev) != 0) {
+        metrics_inc(METRIC_QUEUE_REJECTS);
+        reply_status(&ev, STATUS_ERR_SYSTEM_BUSY, 0);
     }
-    tcp_server_send_response(ev.client_fd, resp);
 }
 
 void supervisor_loop(Supervisor *supervisor) {
+    ControlWindow window = {ATOMIC_VAR_INIT(0)};
     printf("[Supervisor] Event Loop Started.\n");
     while (1) {
         const Event ev = event_queue_pop(&supervisor->queue);
+        // Rate limit assumed by the admission test: excess events wait in the queue
+        while (!control_window_take(&window, supervisor->admission.event_budget)) control_window_wait();
         switch (ev.type) {
             case EV_ACTIVATE: handle_activate(supervisor, ev);
                 break;
             case EV_DEACTIVATE: handle_deactivate(supervisor, ev);
                 break;
-            case EV_LIST: handle_list(supervisor, ev);
+            case EV_TRACE: handle_trace(ev);
+                break;
+            case EV_SUBMIT: handle_submit(ev);
+                break;
+            case EV_RESERVE: handle_reserve(supervisor, ev);
                 break;
-            case EV_INFO: handle_info(supervisor, ev);
+            case EV_UNRESERVE: handle_unreserve(supervisor, ev);
                 break;
             case EV_SHUTDOWN:
+                // Acknowledged only once accepted: a full queue answers ERR System Busy instead
+                reply_status(&ev, STATUS_OK, 0);
                 printf("[Supervisor] Shutdown signal received.\n");
                 return;
             default: break;
@@ -1,4 +1,5 @@
 #include <math.h>
+#include <time.h>
 #include "constants.h"
 #include "task_config.h"
 
@@ -7,7 +8,42 @@ void task_run(const double i) {
     (void) r;
 }
 
-void task_run_for(const TasksConfig* config, const long ms) {
+long task_wcet_ms(const TaskType *type, const Criticality mode) {
+    return type->criticality == CRIT_HI && mode == CRIT_HI ? type->wcet_hi_ms : type->wcet_ms;
+}
+
+bool task_cancelled(const CancelToken *cancel) {
+    if (!cancel) return false;
+    if (atomic_load_explicit(&cancel->requested, memory_order_relaxed)) return true;
+    if (atomic_load_explicit(&cancel->overrun, memory_order_relaxed)) return true;
+    return cancel->abandon && atomic_load_explicit(cancel->abandon, memory_order_relaxed);
+}
+
+bool task_preemption_point(const CancelToken *cancel) {
+    if (cancel && cancel->gate && atomic_load_explicit(&cancel->gate->closed, memory_order_relaxed)) {
+        cancel->gate->wait(cancel->gate, cancel);
+    }
+    return task_cancelled(cancel);
+}
+
+bool task_run_for(const TasksConfig* config, const long ms, const CancelToken *cancel) {
     const unsigned long long max = config->loops_per_ms * ms;
-    for (unsigned long long i = 0; i < max; i++) task_run((double) i);
-}
\ No newline at end of file
+    const unsigned long long chunk = config->loops_per_ms * TASK_CANCEL_POLL_US / 1000 + 1;
+    unsigned long long i = 0;
+    while (i < max) {
+        if (task_preemption_point(cancel)) return false;
+        const unsigned long long end = max - i < chunk ? max : i + chunk;
+        for (; i < end; i++) task_run((double) i);
+    }
+    return true;
+}
+
+bool task_run_cpu_for(const TasksConfig* config, const long ms, const CancelToken *cancel) {
+    struct timespec start, now;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &start);
+    do {
+        if (!task_run_for(config, 1, cancel)) return false;
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    } while ((now.tv_sec - start.tv_sec) * 1000L + (now.tv_nsec - start.tv_nsec) / 1000000L < ms);
+    return true;
+}
@@ -1,9 +1,51 @@
 #include <stdio.h>
+#include <stdatomic.h>
 #include <string.h>
 #include <time.h>
 #include "constants.h"
 #include "task_config.h"
 
+#define T4_OVERRUN_EVERY 10 // Jobs of t4 per job running past its C_LO
+
+static void task_A(const CancelToken *cancel);
+
+static void task_B(const CancelToken *cancel);
+
+static void task_C(const CancelToken *cancel);
+
+static void task_D(const CancelToken *cancel);
+
+TasksConfig tasks_config = {
+    .tasks = {
+        {
+            .name = "t1", .wcet_ms = 50, .period_ms = 300, .deadline_ms = 150,
+            .period_max_ms = 600, .elasticity = 1.0, .routine_fn = task_A
+        },
+        {
+            .name = "t2", .wcet_ms = 100, .period_ms = 500, .deadline_ms = 200,
+            .period_max_ms = 1000, .elasticity = 0.5, .routine_fn = task_B
+        },
+        {
+            .name = "t3", .wcet_ms = 200, .period_ms = 1000, .deadline_ms = 1000,
+            .routine_fn = task_C
+        },
+        {
+            // Safety-critical: certified for 40 ms, admitted in LO mode at its typical 20 ms.
+            // Every T4_OVERRUN_EVERY-th job runs 30 ms and switches the runtime to HI mode
+            .name = "t4", .wcet_ms = 20, .wcet_hi_ms = 40, .criticality = CRIT_HI,
+            .period_ms = 200, .deadline_ms = 100, .routine_fn = task_D
+        }
+    }
+};
+
+static void task_A(const CancelToken *cancel) { task_run_for(&tasks_config, 50, cancel); }
+static void task_B(const CancelToken *cancel) { task_run_for(&tasks_config, 100, cancel); }
+static void task_C(const CancelToken *cancel) { task_run_for(&tasks_config, 200, cancel); }
+static void task_D(const CancelToken *cancel) {
+    static atomic_uint jobs;
+    if (atomic_fetch_add(&jobs, 1) % T4_OVERRUN_EVERY == T4_OVERRUN_EVERY - 1) task_run_cpu_for(&tasks_config, 30, cancel);
+    else task_run_for(&tasks_config, 15, cancel);
+}
 
 void tasks_config_init(TasksConfig* config) {
     struct timespec s, e;
@@ -6,15 +6,67 @@
 #include <stdatomic.h>
 #include <errno.h>
 #include <signal.h>
+#include <semaphore.h>
+#include <unistd.h>
+#include <limits.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
 #include "constants.h"
 #include "task_runtime.h"
+#include "metrics.h"
+#include "task_config.h"
+#include "trace.h"
+#include "profiler.h"
+#include "periodic.h"
+#include "cyclic.h"
 
 static TaskInstance pool[MAX_INSTANCES];
 static pthread_mutex_t pool_mutex = PTHREAD_MUTEX_INITIALIZER;
 static atomic_int id_counter = 1;
+static struct timespec epoch;
+static int task_cpu = CPU_NUMBER;
+static RuntimeMode runtime_mode = RUNTIME_THREADS;
+static const AdmissionPolicy *admission_policy;
+static pthread_t cyclic_thread;
+static atomic_bool cyclic_running;
+static CyclicTable *_Atomic pending_table; // Handed from the supervisor to the executive
+static unsigned int table_generation;       // Of the last table built, under pool_mutex
+static atomic_uint installed_generation;    // Of the table the executive runs
+static atomic_int executing_slot = -1;      // Slot whose job the executive runs, -1 between jobs
+static atomic_bool hi_mode;       // Criticality mode: LO instances drop their jobs while set
+static atomic_ullong hi_since_ns; // Time of the last switch to HI mode (CLOCK_MONOTONIC)
+static sem_t idle_sem;            // Posted at every switch to HI mode
+static pthread_t idle_thread;
+static atomic_bool idle_running;
+
+/*
+ * Runtime side of a tenant reservation. The gate comes first: preemption
+ * points hand it back to budget_wait(). Members share one priority, so the
+ * gate also serves their jobs in release order, as the reservation test
+ * assumes: throttled members all wake at the replenishment, in no set order.
+ */
+typedef struct {
+    BudgetGate gate;
+    atomic_llong budget_ns;
+    atomic_llong period_ns;
+    atomic_ullong usage; // Period index << BUDGET_USED_BITS | ns used in that period
+    atomic_llong queued_ns[MAX_INSTANCES]; // Release each member serves next, by pool slot; LLONG_MAX if none
+    atomic_uint turn;    // Futex word, bumped whenever a member is done with a release
+} ReservationBudget;
+
+static ReservationBudget reservations[MAX_RESERVATIONS];
+static _Thread_local timer_t budget_timer;     // CPU-time timer of a reserved thread
+static _Thread_local bool budget_timed;        // budget_timer exists
+static _Thread_local int budget_ring;          // Pool slot of a reserved thread, its queued_ns entry
+static _Thread_local long long charged_cpu_ns; // Thread CPU time already charged to the reservation
 
 #define NSEC_PER_SEC 1000000000L
 #define MSEC_PER_NSEC 1000000LL
+#define CYCLIC_IDLE_POLL_NS 10000000L // Executive polling for a first table
+#define OVERRUN_SIGNAL SIGUSR2        // Raised in a thread by its C_LO CPU-time timer
+#define BUDGET_SIGNAL SIGRTMIN        // Raised in a reserved thread once the reservation budget is spent
+#define BUDGET_USED_BITS 40           // Up to 18 minutes used per period
+#define BUDGET_USED_MASK ((1ULL << BUDGET_USED_BITS) - 1)
 
 /*
  * Returns a new timespec representing 'ts' + 'ns'.
@@ -46,70 +98,621 @@ static long long diff_ns(const struct timespec t1, const struct timespec t2) {
     return (long long) (t2.tv_sec - t1.tv_sec) * NSEC_PER_SEC + (t2.tv_nsec - t1.tv_nsec);
 }
 
+static uint64_t to_ns(const struct timespec ts) {
+    return (uint64_t) ts.tv_sec * NSEC_PER_SEC + (uint64_t) ts.tv_nsec;
+}
+
+static bool stop_requested(const TaskInstance *inst) {
+    return atomic_load(&inst->cancel.requested);
+}
+
+/*
+ * Slot of the running instance 'id', or -1. Retired slots keep the ID of
+ * their stopped instance until they are reclaimed. Must be called with pool_mutex held.
+ */
+static int find_instance(const int id) {
+    for (int i = 0; i < MAX_INSTANCES; i++) {
+        if (pool[i].active && !pool[i].retired && pool[i].id == id) return i;
+    }
+    return -1;
+}
+
+/*
+ * A slot is free once its instance stopped and, in cyclic mode, once the
+ * executive runs a table that no longer references it.
+ * Must be called with pool_mutex held.
+ */
+static bool slot_free(const TaskInstance *inst) {
+    if (!inst->active) return true;
+    return inst->retired && (int) (atomic_load(&installed_generation) - inst->retired_at) >= 0;
+}
+
+/*
+ * A job ran past its C_LO. A LO job, whose token comes with the signal, is
+ * abandoned at its next preemption point; a HI job switches to HI mode.
+ * Runs in the overrunning thread, so it only touches lock-free atomics and a semaphore.
+ */
+static void overrun_handler(const int signum, siginfo_t *info, void *context) {
+    (void) signum;
+    (void) context;
+    CancelToken *cancel = info->si_value.sival_ptr;
+    if (cancel) {
+        atomic_store(&cancel->overrun, true);
+        metrics_inc(METRIC_JOBS_OVERRUN);
+        return;
+    }
+    if (atomic_exchange(&hi_mode, true)) return;
+    atomic_store(&hi_since_ns, trace_now());
+    metrics_inc(METRIC_MODE_SWITCHES);
+    metrics_gauge_set(GAUGE_CRITICALITY_MODE, CRIT_HI);
+    sem_post(&idle_sem);
+}
+
+/*
+ * Switches back to LO mode at the first idle instant after a switch to HI.
+ * The thread runs on the task core below every task, so it only gets the CPU
+ * once no HI job is pending and the abandoned LO jobs have returned.
+ */
+static void *idle_entry(void *arg) {
+    (void) arg;
+    while (atomic_load(&idle_running)) {
+        if (sem_wait(&idle_sem) != 0) continue; // EINTR
+        if (!atomic_exchange(&hi_mode, false)) continue;
+        metrics_gauge_set(GAUGE_CRITICALITY_MODE, CRIT_LO);
+        printf("[Runtime] Idle instant: back to LO mode after %.2f ms in HI mode\n",
+               (double) (trace_now() - atomic_load(&hi_since_ns)) / MSEC_PER_NSEC);
+    }
+    return NULL;
+}
+
+/*
+ * CPU-time timer of the calling thread, delivering 'signo' with 'value' to it.
+ */
+static int create_cpu_timer(timer_t *timer, const int signo, void *value) {
+    struct sigevent sev = {0};
+    sev.sigev_notify = SIGEV_THREAD_ID;
+    sev.sigev_signo = signo;
+    sev.sigev_value.sival_ptr = value;
+    sev._sigev_un._tid = gettid(); // sigev_notify_thread_id, not exposed by older glibc
+    return timer_create(CLOCK_THREAD_CPUTIME_ID, &sev, timer);
+}
+
+/*
+ * The reservation of the calling thread ran out of budget: close its gate,
+ * the job stops at its next preemption point.
+ */
+static void budget_handler(const int signum, siginfo_t *info, void *context) {
+    (void) signum;
+    (void) context;
+    BudgetGate *gate = info->si_value.sival_ptr;
+    atomic_store(&gate->closed, true);
+}
+
+static long long thread_cpu_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (long long) to_ns(ts);
+}
+
+static long long elapsed_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return diff_ns(epoch, now);
+}
+
+static unsigned long long usage_tag(const long long k) {
+    return (unsigned long long) k << BUDGET_USED_BITS;
+}
+
+/* Budget of 'res' used in its period 'k'. */
+static long long budget_used(const ReservationBudget *res, const long long k) {
+    const unsigned long long u = atomic_load(&res->usage);
+    return (u & ~BUDGET_USED_MASK) == usage_tag(k) ? (long long) (u & BUDGET_USED_MASK) : 0;
+}
+
+/*
+ * Charges the CPU time the calling thread used since its last charge to the
+ * current period. A job that ran across the replenishment can only have used
+ * the time elapsed since in the new period; the rest belonged to the old one.
+ */
+static void budget_charge(ReservationBudget *res) {
+    const long long cpu = thread_cpu_ns();
+    const long long period = atomic_load(&res->period_ns);
+    const long long now = elapsed_ns();
+    const long long k = now / period;
+    long long used = cpu - charged_cpu_ns;
+    if (used > now - k * period) used = now - k * period;
+    charged_cpu_ns = cpu;
+
+    unsigned long long u = atomic_load(&res->usage);
+    unsigned long long next;
+    do {
+        const long long prev = (u & ~BUDGET_USED_MASK) == usage_tag(k) ? (long long) (u & BUDGET_USED_MASK) : 0;
+        next = usage_tag(k) | ((unsigned long long) (prev + used) & BUDGET_USED_MASK);
+    } while (!atomic_compare_exchange_weak(&res->usage, &u, next));
+}
+
+/*
+ * Whether another member of 'res' has a release pending from before the one
+ * of the calling thread, equal releases ordered by pool slot. Later releases
+ * are not pending yet: the caller's own is already due.
+ */
+static bool budget_overtaking(const ReservationBudget *res) {
+    const long long own = atomic_load(&res->queued_ns[budget_ring]);
+    for (int i = 0; i < MAX_INSTANCES; i++) {
+        const long long other = atomic_load(&res->queued_ns[i]);
+        if (other < own || (other == own && i < budget_ring)) return true;
+    }
+    return false;
+}
+
+/*
+ * The calling member is done with its release: queues its next one, or
+ * LLONG_MAX once it stops, and wakes the members waiting for their turn.
+ */
+static void budget_dequeue(ReservationBudget *res, const long long next_ns) {
+    atomic_store(&res->queued_ns[budget_ring], next_ns);
+    atomic_fetch_add(&res->turn, 1);
+    syscall(SYS_futex, &res->turn, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+}
+
+/* Arms the budget timer of the calling thread, 0 disarms it. */
+static void budget_arm(const long long ns) {
+    if (!budget_timed) return;
+    const struct itimerspec arm = {.it_value = timespec_add_ns((struct timespec) {0}, (long) ns)};
+    timer_settime(budget_timer, 0, &arm, NULL);
+}
+
+/*
+ * Waits until the job of the calling thread is the oldest pending one of
+ * 'res' and 'res' has budget left in the current period, then arms the timer
+ * of the calling thread with what is left. Returns early if the job is
+ * cancelled: DEACTIVATE interrupts the sleep.
+ */
+static void budget_acquire(ReservationBudget *res, const CancelToken *cancel) {
+    bool throttled = false;
+    while (!task_cancelled(cancel)) {
+        const unsigned int turn = atomic_load(&res->turn);
+        const long long period = atomic_load(&res->period_ns);
+        if (budget_overtaking(res)) {
+            // Bounded, in case DEACTIVATE signalled just before the wait
+            const struct timespec timeout = timespec_add_ns((struct timespec) {0}, (long) period);
+            syscall(SYS_futex, &res->turn, FUTEX_WAIT_PRIVATE, turn, &timeout, NULL, 0);
+            continue;
+        }
+        const long long k = elapsed_ns() / period;
+        const long long left = atomic_load(&res->budget_ns) - budget_used(res, k);
+        if (left > 0) {
+            atomic_store(&res->gate.closed, false);
+            charged_cpu_ns = thread_cpu_ns();
+            budget_arm(left);
+            return;
+        }
+        if (!throttled) metrics_inc(METRIC_BUDGET_THROTTLES);
+        throttled = true;
+        const struct timespec refill = timespec_add_ns(epoch, (long) ((k + 1) * period));
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &refill, NULL);
+    }
+}
+
+/*
+ * Gate hook, called at a preemption point once the budget timer fired.
+ * Another job may have crossed the replenishment meanwhile: the budget is
+ * recomputed rather than assumed spent.
+ */
+static void budget_wait(BudgetGate *gate, const CancelToken *cancel) {
+    ReservationBudget *res = (ReservationBudget *) gate;
+    budget_arm(0);
+    budget_charge(res);
+    budget_acquire(res, cancel);
+}
+
+/*
+ * Runs one job released at 'release' and accounts for it in the trace,
+ * the profiler and the metrics. A job cancelled by DEACTIVATE, or abandoned
+ * by a LO instance at the switch to HI mode or past its C_LO, is counted
+ * apart: its truncated execution time is not a sample and its end is not
+ * checked against the deadline. A job abandoned past its C_LO still raises
+ * the profiled maximum, so measured admission learns that the task grew.
+ * @param overrun Timer armed with the C_LO budget for the job, NULL if not monitored.
+ * @return The completion time.
+ */
+static struct timespec run_job(const TaskInstance *inst, const int ring, const struct timespec release,
+                               const struct timespec absolute_deadline, const timer_t *overrun) {
+    const int task = (int) (inst->type - tasks_config.tasks);
+    ReservationBudget *res = (ReservationBudget *) inst->cancel.gate;
+    struct timespec start, end, cpu_start, cpu_end;
+
+    if (res) budget_acquire(res, &inst->cancel); // Throttled: the job starts at the replenishment
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    trace_record(ring, TRACE_RELEASE, task, inst->id, 0, to_ns(release));
+    trace_record(ring, TRACE_START, task, inst->id, 0, to_ns(start));
+    if (overrun) {
+        // The C_LO admission analysed, not the current bound: a later measured bound could be larger
+        const struct itimerspec arm = {.it_value = timespec_add_ns((struct timespec) {0}, (long) inst->budget_ns)};
+        timer_settime(*overrun, 0, &arm, NULL);
+    }
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu_start);
+    if (inst->type->routine_fn) inst->type->routine_fn(&inst->cancel);
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu_end);
+    if (overrun) {
+        const struct itimerspec disarm = {0};
+        timer_settime(*overrun, 0, &disarm, NULL);
+    }
+    if (res) {
+        budget_arm(0);
+        budget_charge(res);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    trace_record(ring, TRACE_END, task, inst->id, diff_ns(start, end), to_ns(end));
+    metrics_add(METRIC_BUSY_NS, (unsigned long long) diff_ns(start, end));
+    if (task_cancelled(&inst->cancel)) {
+        metrics_inc(stop_requested(inst) ? METRIC_JOBS_CANCELLED : METRIC_JOBS_DROPPED);
+        // Cut at C_LO, so not a sample, but proof the task can run that long
+        if (atomic_load(&inst->cancel.overrun)) profiler_record_overrun(task, diff_ns(cpu_start, cpu_end));
+        return end;
+    }
+    profiler_record(task, diff_ns(cpu_start, cpu_end));
+    metrics_inc(METRIC_JOBS);
+
+    if (timespec_cmp(&end, &absolute_deadline) > 0) {
+        metrics_inc(METRIC_DEADLINE_MISSES);
+        const long long response_time = diff_ns(release, end);
+        trace_record(ring, TRACE_MISS, task, inst->id, response_time, to_ns(end));
+        printf("[Runtime] DEADLINE MISS: Task %s (ID %d) | Resp: %.2f ms > Limit: %ld ms\n",
+               inst->type->name, inst->id, response_time / 1000000.0, inst->type->deadline_ms);
+    }
+    return end;
+}
+
 static void *thread_entry(void *arg) {
-    const TaskInstance *inst = (TaskInstance *) arg;
-    struct timespec current_activation, start, end;
+    TaskInstance *inst = arg;
+    const int ring = (int) (inst - pool);
+    const int task = (int) (inst->type - tasks_config.tasks);
     const long long deadline_ns = inst->type->deadline_ms * MSEC_PER_NSEC;
-    const long long period_ns = inst->type->period_ms * MSEC_PER_NSEC;
+    struct timespec now;
+
+    // Anchor: Absolute time for first activation, phased against the shared epoch
+    PeriodicClock clk;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    periodic_resume(&clk, inst->offset_ms * MSEC_PER_NSEC, inst->type->period_ms * MSEC_PER_NSEC,
+                    atomic_load(&inst->period_ms) * MSEC_PER_NSEC, inst->anchor_ns, diff_ns(epoch, now));
+    atomic_store(&inst->release_ns, clk.release_ns);
+
+    // Shared pool instances watch their C_LO budget: HI ones switch to HI mode past it, LO ones give up
+    // the job. A reservation budgets its members instead. A timer that cannot be created leaves the job unmonitored
+    timer_t overrun_timer;
+    const bool monitored = !inst->cancel.gate &&
+                           create_cpu_timer(&overrun_timer, OVERRUN_SIGNAL,
+                                            inst->type->criticality == CRIT_LO ? &inst->cancel : NULL) == 0;
+    // Reserved instances watch the reservation budget; without a timer it is only enforced between jobs
+    budget_timed = inst->cancel.gate && create_cpu_timer(&budget_timer, BUDGET_SIGNAL, inst->cancel.gate) == 0;
+    ReservationBudget *res = (ReservationBudget *) inst->cancel.gate;
+    budget_ring = ring;
+    if (res) budget_dequeue(res, clk.release_ns);
+
+    while (!stop_requested(inst)) {
+        const struct timespec current_activation = timespec_add_ns(epoch, clk.release_ns);
+        const int ret = clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &current_activation, NULL);
+        if (ret == EINTR) continue; // Re-check the stop flag before sleeping again
+
+        struct timespec end;
+        atomic_store(&inst->cancel.overrun, false);
+        if (task_cancelled(&inst->cancel)) {
+            // LO instance in HI mode: the release is skipped
+            clock_gettime(CLOCK_MONOTONIC, &end);
+            metrics_inc(METRIC_JOBS_DROPPED);
+        } else {
+            end = run_job(inst, ring, current_activation,
+                          timespec_add_ns(epoch, periodic_deadline(&clk, deadline_ns)),
+                          monitored ? &overrun_timer : NULL);
+        }
 
-    // Anchor: Absolute time for first activation
+        // Elastic period change: takes effect from the next release on
+        periodic_advance(&clk, atomic_load(&inst->period_ms) * MSEC_PER_NSEC);
+        atomic_store(&inst->release_ns, clk.release_ns);
+        if (res) budget_dequeue(res, clk.release_ns);
+        trace_record(ring, TRACE_SLEEP, task, inst->id, (int64_t) (to_ns(epoch) + clk.release_ns), to_ns(end));
+    }
+    if (monitored) timer_delete(overrun_timer);
+    if (budget_timed) timer_delete(budget_timer);
+    if (res) budget_dequeue(res, LLONG_MAX);
+    return NULL;
+}
 
-    clock_gettime(CLOCK_MONOTONIC, &current_activation);
-    while (!inst->stop) {
-        struct timespec absolute_deadline = timespec_add_ns(current_activation, deadline_ns);
+/*
+ * Runs the job of entry 'e' in the cycle starting at 'cycle_ns', unless its
+ * instance was stopped. A stop either sees the slot busy and waits for the
+ * job to return, or the executive sees the stop and skips the job.
+ */
+static void run_entry(const CyclicEntry *e, const long long cycle_ns) {
+    atomic_store(&executing_slot, e->ref);
+    if (!stop_requested(&pool[e->ref])) {
+        run_job(&pool[e->ref], e->ref, timespec_add_ns(epoch, cycle_ns + e->release_ms * MSEC_PER_NSEC),
+                timespec_add_ns(epoch, cycle_ns + e->deadline_ms * MSEC_PER_NSEC), NULL);
+    }
+    atomic_store(&executing_slot, -1);
+}
 
-        clock_gettime(CLOCK_MONOTONIC, &start);
-        if (inst->type->routine_fn) inst->type->routine_fn();
-        clock_gettime(CLOCK_MONOTONIC, &end);
+/*
+ * Runs the jobs of 'table' the executive has not started yet and that are
+ * released in [from_ns, until_ns): what is left of frame 'frame' onwards in
+ * the cycle starting at 'cycle_ns', then the jobs of the next cycle released
+ * early enough, wrapped ones included.
+ */
+static void run_carried(const CyclicTable *table, const long long cycle_ns, const int frame, const long long from_ns,
+                        const long long until_ns) {
+    const long long next_ns = cycle_ns + table->hyperperiod_ms * MSEC_PER_NSEC;
+    for (int i = table->frame_first[frame]; i < table->entry_count * 2; i++) {
+        const CyclicEntry *e = &table->entries[i % table->entry_count];
+        const long long base_ns = i < table->entry_count ? cycle_ns : next_ns;
+        const long long release_ns = base_ns + e->release_ms * MSEC_PER_NSEC;
+        if (release_ns >= from_ns && release_ns < until_ns) run_entry(e, base_ns);
+    }
+}
+
+/*
+ * First frame boundary of 'table' that is not in the past, relative to the epoch.
+ */
+static long long next_boundary_ns(const CyclicTable *table) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    const long long elapsed = diff_ns(epoch, now);
+    if (table->frame_count == 0) return elapsed;
+    const long long frame_ns = table->frame_ms * MSEC_PER_NSEC;
+    return (elapsed + frame_ns - 1) / frame_ns * frame_ns;
+}
 
-        if (timespec_cmp(&end, &absolute_deadline) > 0) {
-            const long long response_time = diff_ns(current_activation, end);
-            printf("[Runtime] DEADLINE MISS: Task %s (ID %d) | Resp: %.2f ms > Limit: %ld ms\n",
-                   inst->type->name, inst->id, response_time / 1000000.0, inst->type->deadline_ms);
+/*
+ * Cyclic executive: one thread runs the jobs of every instance from the
+ * static table, frame by frame on the epoch grid. A new table takes over at
+ * its own next frame boundary, the old one runs its frames until then. The
+ * jobs the old table released before the switch and had not run yet are
+ * carried over and run first; the new table serves the releases from the
+ * switch on, so no release is dropped or run twice. Entries of stopped
+ * instances are skipped; their slots are reclaimed once the executive runs
+ * a table built without them.
+ */
+static void *cyclic_entry(void *arg) {
+    (void) arg;
+    CyclicTable *table = NULL;
+    CyclicTable *incoming = NULL;
+    long long cycle_ns = 0;  // Start of the current cycle, relative to the epoch
+    long long floor_ns = 0;  // Releases before this were served by the previous table
+    long long switch_ns = 0; // Frame boundary the incoming table takes over at
+    int frame = 0;
+
+    while (atomic_load(&cyclic_running)) {
+        CyclicTable *next = atomic_exchange(&pending_table, NULL);
+        if (next) {
+            cyclic_free(incoming); // Superseded before it took over
+            incoming = next;
+            switch_ns = next_boundary_ns(incoming);
+        }
+
+        const bool idle = !table || table->frame_count == 0;
+        const long long frame_start = idle ? 0 : cycle_ns + frame * table->frame_ms * MSEC_PER_NSEC;
+        if (incoming && (idle || frame_start >= switch_ns)) {
+            const struct timespec wake = timespec_add_ns(epoch, switch_ns);
+            if (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wake, NULL) == EINTR) continue;
+            if (!idle) run_carried(table, cycle_ns, frame, floor_ns, switch_ns);
+            cyclic_free(table);
+            table = incoming;
+            incoming = NULL;
+            floor_ns = switch_ns;
+            if (table->frame_count > 0) {
+                const long long k = switch_ns / (table->frame_ms * MSEC_PER_NSEC);
+                frame = (int) (k % table->frame_count);
+                cycle_ns = (k - frame) * table->frame_ms * MSEC_PER_NSEC;
+            }
+            atomic_store(&installed_generation, table->generation); // Slots only the old table held are free
+            continue;
+        }
+        if (idle) {
+            const struct timespec poll_interval = {.tv_sec = 0, .tv_nsec = CYCLIC_IDLE_POLL_NS};
+            clock_nanosleep(CLOCK_MONOTONIC, 0, &poll_interval, NULL);
+            continue;
         }
 
-        current_activation = timespec_add_ns(current_activation, period_ns);
+        const struct timespec wake = timespec_add_ns(epoch, frame_start);
+        if (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wake, NULL) == EINTR) continue;
+
+        for (int i = table->frame_first[frame]; i < table->frame_first[frame + 1]; i++) {
+            const CyclicEntry *e = &table->entries[i];
+            const long long release_ns = cycle_ns + e->release_ms * MSEC_PER_NSEC;
+            if (release_ns >= floor_ns) run_entry(e, cycle_ns);
+        }
 
-        while (!inst->stop) {
-            const int ret = clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &current_activation, NULL);
-            if (ret == 0) break;
-            if (ret == EINTR) break;
+        if (++frame == table->frame_count) {
+            frame = 0;
+            cycle_ns += table->hyperperiod_ms * MSEC_PER_NSEC;
         }
     }
+    cyclic_free(incoming);
+    cyclic_free(table);
     return NULL;
 }
 
-void runtime_init(void) {
+/*
+ * Builds the table for the instances still running and hands it to the executive.
+ * A stopped instance keeps its slot until the executive runs this table or a later one.
+ * Must be called with pool_mutex held.
+ */
+static void rebuild_table(void) {
+    Task set[MAX_INSTANCES];
+    int slots[MAX_INSTANCES];
+    int count = 0;
+
+    for (int i = 0; i < MAX_INSTANCES; i++) {
+        if (!pool[i].active || stop_requested(&pool[i])) continue;
+        set[count] = (Task){
+            .type = pool[i].type, .instance_id = pool[i].id, .offset_ms = pool[i].offset_ms,
+            .period_ms = atomic_load(&pool[i].period_ms), .wcet_us = pool[i].budget_ns / 1000
+        };
+        slots[count++] = i;
+    }
+
+    CyclicTable *table = admission_cyclic_table(admission_policy, set, count);
+    if (!table) {
+        fprintf(stderr, "[Runtime] No cyclic table for the new set, keeping the current one\n");
+        return;
+    }
+    for (int i = 0; i < table->entry_count; i++) table->entries[i].ref = slots[table->entries[i].ref];
+    table->generation = ++table_generation;
+    printf("[Runtime] Cyclic table: H=%ld ms, frame=%ld ms, %d jobs\n",
+           table->hyperperiod_ms, table->frame_ms, table->entry_count);
+    cyclic_free(atomic_exchange(&pending_table, table)); // Replaces a table not yet picked up
+}
+
+static int start_executive(void) {
+    pthread_attr_t attr;
+    const struct sched_param param = {.sched_priority = TASK_PRIORITY_MAX};
+    cpu_set_t cpus;
+
+    CPU_ZERO(&cpus);
+    CPU_SET(task_cpu, &cpus);
+    pthread_attr_init(&attr);
+    pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+    pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+    pthread_attr_setschedparam(&attr, &param);
+    pthread_attr_setaffinity_np(&attr, sizeof(cpus), &cpus);
+
+    atomic_store(&cyclic_running, true);
+    const int err = pthread_create(&cyclic_thread, &attr, cyclic_entry, NULL);
+    pthread_attr_destroy(&attr);
+    if (err != 0) {
+        atomic_store(&cyclic_running, false);
+        fprintf(stderr, "[Runtime] Error creating cyclic executive. Check sudo/permissions.\n");
+        return -1;
+    }
+    printf("[Runtime] Cyclic executive started on CPU %d\n", task_cpu);
+    return 0;
+}
+
+/*
+ * Mixed criticality support of the threads mode: the overrun signal handler
+ * and the idle detector.
+ */
+static int start_idle_detector(void) {
+    pthread_attr_t attr;
+    const struct sched_param param = {.sched_priority = IDLE_PRIORITY};
+    struct sigaction sa;
+    cpu_set_t cpus;
+
+    sa.sa_sigaction = overrun_handler;
+    sa.sa_flags = SA_SIGINFO | SA_RESTART; // Fires inside a job, not in a blocking call
+    sigemptyset(&sa.sa_mask);
+    sigaction(OVERRUN_SIGNAL, &sa, NULL);
+    sem_init(&idle_sem, 0, 0);
+
+    CPU_ZERO(&cpus);
+    CPU_SET(task_cpu, &cpus);
+    pthread_attr_init(&attr);
+    pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+    pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+    pthread_attr_setschedparam(&attr, &param);
+    pthread_attr_setaffinity_np(&attr, sizeof(cpus), &cpus);
+
+    atomic_store(&idle_running, true);
+    const int err = pthread_create(&idle_thread, &attr, idle_entry, NULL);
+    pthread_attr_destroy(&attr);
+    if (err != 0) {
+        atomic_store(&idle_running, false);
+        fprintf(stderr, "[Runtime] Error creating idle detector. Check sudo/permissions.\n");
+        return -1;
+    }
+    return 0;
+}
+
+static void install_budget_handler(void) {
+    struct sigaction sa;
+    sa.sa_sigaction = budget_handler;
+    sa.sa_flags = SA_SIGINFO | SA_RESTART; // Fires inside a job, not in a blocking call
+    sigemptyset(&sa.sa_mask);
+    sigaction(BUDGET_SIGNAL, &sa, NULL);
+}
+
+int runtime_init(const int cpu, const RuntimeMode mode, const AdmissionPolicy *policy) {
     pthread_mutex_lock(&pool_mutex);
+    task_cpu = cpu;
+    runtime_mode = mode;
+    admission_policy = policy;
     for (int i = 0; i < MAX_INSTANCES; i++) {
         pool[i].active = false;
+        pool[i].retired = false;
         pool[i].id = -1;
     }
+    for (int r = 0; r < MAX_RESERVATIONS; r++) {
+        for (int i = 0; i < MAX_INSTANCES; i++) atomic_store(&reservations[r].queued_ns[i], LLONG_MAX);
+    }
     atomic_store(&id_counter, 1);
+    clock_gettime(CLOCK_MONOTONIC, &epoch);
+    atomic_store(&hi_mode, false);
+    metrics_gauge_set(GAUGE_CRITICALITY_MODE, CRIT_LO);
+    pthread_mutex_unlock(&pool_mutex);
+    if (mode == RUNTIME_CYCLIC) return start_executive();
+    install_budget_handler();
+    return start_idle_detector();
+}
+
+int runtime_reserve(const int slot, const long budget_ms, const long period_ms) {
+    if (slot < 0 || slot >= MAX_RESERVATIONS) return -1;
+    ReservationBudget *res = &reservations[slot];
+
+    pthread_mutex_lock(&pool_mutex);
+    res->gate.wait = budget_wait;
+    atomic_store(&res->budget_ns, budget_ms * MSEC_PER_NSEC);
+    atomic_store(&res->period_ns, period_ms * MSEC_PER_NSEC);
     pthread_mutex_unlock(&pool_mutex);
+    return 0;
+}
+
+Criticality runtime_criticality_mode(void) {
+    return atomic_load(&hi_mode) ? CRIT_HI : CRIT_LO;
 }
 
-int runtime_create_instance(const TaskType *type) {
+/*
+ * Claims a pool slot and starts the instance. A negative 'id' assigns the next
+ * free ID; otherwise 'id' is reused and must not be running.
+ */
+static int spawn_instance(const TaskType *type, const int id_hint, const long offset_ms, const long period_ms,
+                          const long long anchor_ns, const int reservation, const int priority, const long long wcet_us) {
     pthread_mutex_lock(&pool_mutex);
     int idx = -1;
-    for (int i = 0; i < MAX_INSTANCES; i++) {
-        if (!pool[i].active) {
-            idx = i;
-            break;
-        }
+    for (int i = 0; i < MAX_INSTANCES && idx == -1; i++) {
+        if (slot_free(&pool[i])) idx = i;
     }
 
-    if (idx == -1) {
+    if (idx == -1 || (id_hint >= 0 && find_instance(id_hint) >= 0)) {
         pthread_mutex_unlock(&pool_mutex);
         return -1;
     }
 
     TaskInstance *inst = &pool[idx];
-    inst->id = atomic_fetch_add(&id_counter, 1);
+    inst->retired = false;
+    inst->id = id_hint >= 0 ? id_hint : atomic_fetch_add(&id_counter, 1);
     inst->type = type;
-    inst->stop = false;
+    inst->offset_ms = offset_ms;
+    atomic_store(&inst->period_ms, period_ms);
+    atomic_store(&inst->release_ns, -1);
+    inst->anchor_ns = anchor_ns;
+    inst->budget_ns = wcet_us * 1000LL;
+    atomic_store(&inst->cancel.requested, false);
+    atomic_store(&inst->cancel.overrun, false);
+    // Only preemptive threads can drop LO work; the cyclic table budgets HI tasks at C_HI
+    // and a reservation is budgeted as HI, whatever its members
+    inst->cancel.abandon = runtime_mode == RUNTIME_THREADS && type->criticality == CRIT_LO && reservation < 0
+                               ? &hi_mode : NULL;
+    inst->cancel.gate = reservation >= 0 ? &reservations[reservation].gate : NULL;
     inst->active = true;
 
+    if (runtime_mode == RUNTIME_CYCLIC) {
+        rebuild_table();
+        const int id = inst->id;
+        pthread_mutex_unlock(&pool_mutex);
+        return id;
+    }
+
     pthread_attr_t attr;
     struct sched_param param;
 
@@ -117,12 +720,14 @@ int runtime_create_instance(const TaskType *type) {
     pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
     pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
 
-    // DM: Higher frequency = Higher Priority
-    // Mapped to range [1, 90] to leave room for system threads
-    const int prio = 90 - (int) (type->deadline_ms / 100);
-    param.sched_priority = (prio < 1) ? 1 : (prio > 90) ? 90 : prio;
+    param.sched_priority = priority;
     pthread_attr_setschedparam(&attr, &param);
 
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(task_cpu, &cpus);
+    pthread_attr_setaffinity_np(&attr, sizeof(cpus), &cpus);
+
     if (pthread_create(&inst->thread, &attr, thread_entry, inst) != 0) {
         inst->active = false;
         pthread_attr_destroy(&attr);
@@ -137,22 +742,55 @@ int runtime_create_instance(const TaskType *type) {
     return id;
 }
 
-int runtime_stop_instance(const int id) {
-    pthread_mutex_lock(&pool_mutex);
-    int idx = -1;
-    for (int i = 0; i < MAX_INSTANCES; i++) {
-        if (pool[i].active && pool[i].id == id) {
-            idx = i;
-            break;
-        }
+int runtime_create_instance(const TaskType *type, const long offset_ms, const long period_ms, const int reservation,
+                            const int priority, const long long wcet_us) {
+    return spawn_instance(type, -1, offset_ms, period_ms, -1, reservation, priority, wcet_us);
+}
+
+int runtime_restore_instance(const TaskType *type, const int id, const long offset_ms, const long period_ms,
+                             const long long anchor_ns, const int reservation, const int priority,
+                             const long long wcet_us) {
+    if (id <= 0) return -1;
+    // Never hand out a restored ID again
+    int next = atomic_load(&id_counter);
+    while (next <= id && !atomic_compare_exchange_weak(&id_counter, &next, id + 1)) {
     }
+    return spawn_instance(type, id, offset_ms, period_ms, anchor_ns, reservation, priority, wcet_us);
+}
 
+long long runtime_next_release_ns(const int id) {
+    long long release = -1;
+    pthread_mutex_lock(&pool_mutex);
+    const int idx = find_instance(id);
+    if (idx >= 0) release = atomic_load(&pool[idx].release_ns);
+    pthread_mutex_unlock(&pool_mutex);
+    return release;
+}
+
+int runtime_stop_instance(const int id) {
+    pthread_mutex_lock(&pool_mutex);
+    const int idx = find_instance(id);
     if (idx == -1) {
         pthread_mutex_unlock(&pool_mutex);
         return -1;
     }
 
-    pool[idx].stop = true;
+    // Seen by the job within TASK_CANCEL_POLL_US of its CPU time, so the join below is short
+    atomic_store(&pool[idx].cancel.requested, true);
+
+    if (runtime_mode == RUNTIME_CYCLIC) {
+        // No thread to join: the executive skips the entries of stopped instances,
+        // and keeps using the slot until it runs a table built without it
+        pool[idx].retired = true;
+        pool[idx].retired_at = table_generation + 1;
+        rebuild_table();
+        pthread_mutex_unlock(&pool_mutex);
+
+        // Like the join of threads mode: a job in progress returns within a poll interval of its CPU time
+        const struct timespec poll_interval = {.tv_sec = 0, .tv_nsec = TASK_CANCEL_POLL_US * 1000L};
+        while (atomic_load(&executing_slot) == idx) clock_nanosleep(CLOCK_MONOTONIC, 0, &poll_interval, NULL);
+        return 0;
+    }
 
     // Interrupt nanosleep immediately to avoid waiting for the full period
     pthread_kill(pool[idx].thread, SIGUSR1);
@@ -167,12 +805,79 @@ int runtime_stop_instance(const int id) {
     return 0;
 }
 
+int runtime_set_period(const int id, const long period_ms) {
+    pthread_mutex_lock(&pool_mutex);
+    const int idx = find_instance(id);
+    if (idx >= 0) {
+        atomic_store(&pool[idx].period_ms, period_ms);
+        if (runtime_mode == RUNTIME_CYCLIC) rebuild_table();
+    }
+    pthread_mutex_unlock(&pool_mutex);
+    return idx >= 0 ? 0 : -1;
+}
+
+int runtime_set_priority(const int id, const int priority) {
+    pthread_mutex_lock(&pool_mutex);
+    const int idx = find_instance(id);
+    if (idx >= 0 && runtime_mode == RUNTIME_THREADS) {
+        const struct sched_param param = {.sched_priority = priority};
+        pthread_setschedparam(pool[idx].thread, SCHED_FIFO, &param);
+    }
+    pthread_mutex_unlock(&pool_mutex);
+    return idx >= 0 ? 0 : -1;
+}
+
+void runtime_resume_point(long long *epoch_realtime_ns, int *next_id) {
+    struct timespec mono, real;
+    clock_gettime(CLOCK_MONOTONIC, &mono);
+    clock_gettime(CLOCK_REALTIME, &real);
+    *epoch_realtime_ns = (long long) to_ns(real) - diff_ns(epoch, mono);
+    *next_id = atomic_load(&id_counter);
+}
+
+int runtime_resume(const long long epoch_realtime_ns, const int next_id) {
+    struct timespec mono, real;
+    int ret = -1;
+
+    pthread_mutex_lock(&pool_mutex);
+    if (next_id > atomic_load(&id_counter)) atomic_store(&id_counter, next_id);
+    clock_gettime(CLOCK_MONOTONIC, &mono);
+    clock_gettime(CLOCK_REALTIME, &real);
+    const long long age_ns = (long long) to_ns(real) - epoch_realtime_ns;
+    if (age_ns >= 0 && age_ns <= (long long) to_ns(mono)) { // Not in the future, not before this boot
+        const struct timespec zero = {0};
+        epoch = timespec_add_ns(zero, (long) ((long long) to_ns(mono) - age_ns));
+        ret = 0;
+    }
+    pthread_mutex_unlock(&pool_mutex);
+    return ret;
+}
+
+long long runtime_elapsed_ms(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return diff_ns(epoch, now) / MSEC_PER_NSEC;
+}
+
 void runtime_cleanup(void) {
+    if (atomic_exchange(&cyclic_running, false)) {
+        pthread_kill(cyclic_thread, SIGUSR1);
+        pthread_join(cyclic_thread, NULL);
+        cyclic_free(atomic_exchange(&pending_table, NULL));
+        pthread_mutex_lock(&pool_mutex);
+        for (int i = 0; i < MAX_INSTANCES; i++) {
+            pool[i].active = false;
+            pool[i].retired = false;
+        }
+        pthread_mutex_unlock(&pool_mutex);
+        return;
+    }
+
     pthread_mutex_lock(&pool_mutex);
     // Signal all threads to stop
     for (int i = 0; i < MAX_INSTANCES; i++) {
         if (pool[i].active) {
-            pool[i].stop = true;
+            atomic_store(&pool[i].cancel.requested, true);
             pthread_kill(pool[i].thread, SIGUSR1);
         }
     }
@@ -191,4 +896,10 @@ void runtime_cleanup(void) {
 
         if (active) pthread_join(t, NULL);
     }
+
+    if (atomic_exchange(&idle_running, false)) {
+        sem_post(&idle_sem);
+        pthread_join(idle_thread, NULL);
+        sem_destroy(&idle_sem);
+    }
 }
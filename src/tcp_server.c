@@ -4,11 +4,21 @@
 #include <arpa/inet.h>
 #include <fcntl.h>
 #include <poll.h>
+#include <pthread.h>
 #include "tcp_server.h"
 #include "supervisor.h"
 #include "event.h"
+#include "metrics.h"
+#include "task_runtime.h"
 #include <errno.h>
 
+static FILE *record_file;
+static char admin_token[ACCESS_TOKEN_LEN]; // Empty: ADMIN always fails
+// Replies come from the network and supervisor threads: the queues and the
+// client slots they are looked up by are guarded by out_mutex
+static TcpServer *server;
+static pthread_mutex_t out_mutex = PTHREAD_MUTEX_INITIALIZER;
+
 int tcp_server_init(TcpServer *svr, const int port) {
     // Initialize structure defaults
     svr->server_fd = -1;
@@ -16,8 +26,16 @@ int tcp_server_init(TcpServer *svr, const int port) {
         svr->poll_fds[i].fd = -1;
         svr->poll_fds[i].events = 0;
         svr->client_buf_lens[i] = 0;
+        svr->client_discard[i] = false;
+        svr->client_pending[i] = false;
+        svr->client_tenant[i][0] = '\0';
+        memset(svr->client_token[i], 0, ACCESS_TOKEN_LEN);
+        svr->client_admin[i] = false;
+        svr->client_out_lens[i] = 0;
+        svr->client_overflow[i] = false;
         memset(svr->client_buffers[i], 0, NET_BUFFER_SIZE);
     }
+    server = svr;
 
     const int server_fd = socket(AF_INET, SOCK_STREAM, 0);
     if (server_fd < 0) {
@@ -49,30 +67,135 @@ int tcp_server_init(TcpServer *svr, const int port) {
 }
 
 
-static void handle_line(Supervisor* spv, const int fd, char *line) {
+int tcp_server_record_commands(const char *path) {
+    record_file = fopen(path, "a");
+    if (!record_file) {
+        perror("[Net] Failed to open command record");
+        return -1;
+    }
+    printf("[Net] Recording commands to %s\n", path);
+    return 0;
+}
+
+int tcp_server_set_admin_token(const char *token) {
+    if (token[0] == '\0' || strlen(token) >= ACCESS_TOKEN_LEN) return -1;
+    memset(admin_token, 0, sizeof(admin_token));
+    memcpy(admin_token, token, strlen(token));
+    return 0;
+}
+
+static void handle_line(Supervisor* spv, TcpServer *svr, const int i, char *line) {
+    const int fd = svr->poll_fds[i].fd;
     line[strcspn(line, "\r\n")] = '\0';
     if (strlen(line) == 0) return;
 
     Event ev;
+    metrics_inc(METRIC_COMMANDS);
     if (event_parse(line, fd, &ev) != 0) {
+        metrics_inc(METRIC_INVALID_COMMANDS);
         tcp_server_send_response(fd, "ERR Invalid Command\n");
         return;
     }
+    if (ev.type == EV_TENANT) {
+        // The reservation and token are checked by the commands that use them: it may be created later
+        memcpy(svr->client_tenant[i], ev.payload.tenant.name, TASK_NAME_LEN);
+        memcpy(svr->client_token[i], ev.payload.tenant.token, ACCESS_TOKEN_LEN);
+        tcp_server_send_response(fd, "OK\n");
+        return;
+    }
+    if (ev.type == EV_ADMIN) {
+        svr->client_admin[i] = event_token_equal(admin_token, ev.payload.admin.token);
+        if (!svr->client_admin[i]) metrics_inc(METRIC_INVALID_COMMANDS);
+        tcp_server_send_response(fd, svr->client_admin[i] ? "OK\n" : "ERR Permission Denied\n");
+        return;
+    }
+    memcpy(ev.tenant, svr->client_tenant[i], TASK_NAME_LEN);
+    memcpy(ev.token, svr->client_token[i], ACCESS_TOKEN_LEN);
+    ev.admin = svr->client_admin[i];
+
+    if (record_file) {
+        fprintf(record_file, "%lld %s\n", runtime_elapsed_ms(), line);
+        fflush(record_file);
+    }
 
+    supervisor_dispatch(spv, ev);
+}
+
+/*
+ * Sends as much of client 'i's queued output as its socket takes.
+ * Must be called with out_mutex held.
+ */
+static void flush_output(TcpServer *svr, const int i) {
+    const ssize_t n = send(svr->poll_fds[i].fd, svr->client_out[i], svr->client_out_lens[i], MSG_NOSIGNAL);
+    if (n <= 0) return; // Full again, or broken: the next recv reports it
+    svr->client_out_lens[i] -= (size_t) n;
+    memmove(svr->client_out[i], svr->client_out[i] + n, svr->client_out_lens[i]);
+}
+
+static void close_client(TcpServer *svr, const int i) {
+    pthread_mutex_lock(&out_mutex);
+    close(svr->poll_fds[i].fd);
+    svr->poll_fds[i].fd = -1;
+    svr->poll_fds[i].events = POLLIN;
+    svr->client_buf_lens[i] = 0;
+    svr->client_out_lens[i] = 0;
+    svr->client_overflow[i] = false;
+    pthread_mutex_unlock(&out_mutex);
+    metrics_gauge_add(GAUGE_CONNECTIONS_OPEN, -1);
+}
+
+/*
+ * Dispatches the complete lines buffered for client 'i' while the command
+ * budget lasts, then keeps the unfinished tail for the next read.
+ */
+static void dispatch_lines(Supervisor *spv, TcpServer *svr, const int i) {
+    char *buf = svr->client_buffers[i];
+    char *line = buf;
+    char *nl;
 
-    if (ev.type == EV_SHUTDOWN) {
-        tcp_server_send_response(fd, "OK Shutting Down\n");
+    // Pipelined clients may deliver several commands, or part of one, per read
+    svr->client_pending[i] = false;
+    while ((nl = memchr(line, '\n', svr->client_buf_lens[i] - (line - buf))) != NULL) {
+        if (!control_window_take(&spv->command_window, spv->admission.command_budget)) {
+            svr->client_pending[i] = true;
+            break;
+        }
+        *nl = '\0';
+        if (svr->client_discard[i]) svr->client_discard[i] = false; // Tail of an oversized line
+        else handle_line(spv, svr, i, line);
+        line = nl + 1;
     }
 
-    // Push to supervisor queue. If full, reject immediately to prevent timeout.
-    if (event_queue_push(&spv->queue, ev) != 0) {
-        tcp_server_send_response(fd, "ERR System Busy\n");
+    const long rest = svr->client_buf_lens[i] - (line - buf);
+    if (!svr->client_pending[i] && rest >= NET_BUFFER_SIZE - 1) {
+        metrics_inc(METRIC_INVALID_COMMANDS);
+        tcp_server_send_response(svr->poll_fds[i].fd, "ERR Line Too Long\n");
+        svr->client_buf_lens[i] = 0;
+        svr->client_discard[i] = true;
+        return;
     }
+    memmove(buf, line, rest);
+    svr->client_buf_lens[i] = rest;
+    buf[rest] = '\0';
 }
 
 void tcp_server_poll(Supervisor* spv, TcpServer *svr) {
     struct pollfd *poll_fds = svr->poll_fds;
 
+    // Command budget spent: serve nothing until the next interval
+    if (!control_window_available(&spv->command_window, spv->admission.command_budget)) {
+        control_window_wait();
+    }
+    for (int i = 1; i <= MAX_CLIENTS; i++) {
+        if (poll_fds[i].fd != -1 && svr->client_pending[i]) dispatch_lines(spv, svr, i);
+    }
+
+    pthread_mutex_lock(&out_mutex);
+    for (int i = 1; i <= MAX_CLIENTS; i++) {
+        poll_fds[i].events = svr->client_out_lens[i] > 0 ? POLLIN | POLLOUT : POLLIN;
+    }
+    pthread_mutex_unlock(&out_mutex);
+
     const int ret = poll(poll_fds, MAX_CLIENTS + 1, 100);
     if (ret <= 0) return;
 
@@ -83,15 +206,27 @@ void tcp_server_poll(Supervisor* spv, TcpServer *svr) {
             int added = 0;
             for (int i = 1; i <= MAX_CLIENTS; i++) {
                 if (poll_fds[i].fd == -1) {
+                    pthread_mutex_lock(&out_mutex);
                     poll_fds[i].fd = new_sock;
                     poll_fds[i].events = POLLIN;
+                    svr->client_out_lens[i] = 0;
+                    svr->client_overflow[i] = false;
+                    pthread_mutex_unlock(&out_mutex);
                     svr->client_buf_lens[i] = 0;
+                    svr->client_discard[i] = false;
+                    svr->client_pending[i] = false;
+                    svr->client_tenant[i][0] = '\0';
+                    memset(svr->client_token[i], 0, ACCESS_TOKEN_LEN);
+                    svr->client_admin[i] = false;
                     added = 1;
+                    metrics_inc(METRIC_CONNECTIONS);
+                    metrics_gauge_add(GAUGE_CONNECTIONS_OPEN, 1);
                     printf("[Net] Client connected on FD %d\n", new_sock);
                     break;
                 }
             }
             if (!added) {
+                metrics_inc(METRIC_CONNECTIONS_REJECTED);
                 printf("[Net] Max clients reached, rejecting FD %d\n", new_sock);
                 close(new_sock);
             }
@@ -100,36 +235,93 @@ void tcp_server_poll(Supervisor* spv, TcpServer *svr) {
 
     for (int i = 1; i <= MAX_CLIENTS; i++) {
         if (poll_fds[i].fd == -1) continue;
+
+        pthread_mutex_lock(&out_mutex);
+        const bool overflow = svr->client_overflow[i];
+        if (!overflow && (poll_fds[i].revents & POLLOUT)) flush_output(svr, i);
+        pthread_mutex_unlock(&out_mutex);
+        if (overflow) {
+            printf("[Net] Client FD %d is not reading its replies, disconnecting\n", poll_fds[i].fd);
+            close_client(svr, i);
+            continue;
+        }
+
+        if (svr->client_pending[i]) continue; // Its buffer is full of unserved lines
         if (!(poll_fds[i].revents & (POLLIN | POLLHUP | POLLERR))) continue;
 
-        const ssize_t n = recv(poll_fds[i].fd, svr->client_buffers[i], NET_BUFFER_SIZE - 1, 0);
+        char *buf = svr->client_buffers[i];
+        const ssize_t n = recv(poll_fds[i].fd, buf + svr->client_buf_lens[i],
+                               NET_BUFFER_SIZE - 1 - svr->client_buf_lens[i], 0);
 
         if (n <= 0) {
             printf("[Net] Client FD %d disconnected\n", poll_fds[i].fd);
-            close(poll_fds[i].fd);
-            poll_fds[i].fd = -1;
-            svr->client_buf_lens[i] = 0;
+            close_client(svr, i);
             continue;
         }
 
-        svr->client_buffers[i][n] = '\0';
-        handle_line(spv, poll_fds[i].fd, svr->client_buffers[i]);
-        svr->client_buf_lens[i] = 0;
+        svr->client_buf_lens[i] += n;
+        buf[svr->client_buf_lens[i]] = '\0';
+        dispatch_lines(spv, svr, i);
     }
 }
-void tcp_server_send_response(const int client_fd, const char *msg) {
-    if (client_fd >= 0) {
-        char buf[NET_RESPONSE_BUF_SIZE];
-        snprintf(buf, sizeof(buf), "[SERVER]: %s", msg);
-        send(client_fd, buf, strlen(buf), MSG_NOSIGNAL);
+
+/*
+ * Sends 'len' bytes to 'client_fd', queueing what its socket does not take
+ * behind any output already queued, so replies never interleave. Neither
+ * thread that replies may block on a client that does not read.
+ */
+static void send_or_queue(const int client_fd, const char *msg, size_t len) {
+    if (client_fd < 0) return;
+
+    pthread_mutex_lock(&out_mutex);
+    int i = 1;
+    while (server && i <= MAX_CLIENTS && server->poll_fds[i].fd != client_fd) i++;
+    if (!server || i > MAX_CLIENTS) {
+        // Disconnected before its reply: the descriptor may belong to someone else now
+        pthread_mutex_unlock(&out_mutex);
+        return;
+    }
+
+    if (server->client_out_lens[i] == 0) {
+        const ssize_t n = send(client_fd, msg, len, MSG_NOSIGNAL);
+        if (n > 0) {
+            msg += n;
+            len -= (size_t) n;
+        } else if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+            len = 0; // Broken connection: the next recv reports it
+        }
+    }
+    if (len > NET_OUTPUT_QUEUE_SIZE - server->client_out_lens[i]) {
+        server->client_overflow[i] = true;
+    } else if (len > 0 && !server->client_overflow[i]) {
+        memcpy(server->client_out[i] + server->client_out_lens[i], msg, len);
+        server->client_out_lens[i] += len;
     }
+    pthread_mutex_unlock(&out_mutex);
+}
+
+void tcp_server_send_response(const int client_fd, const char *msg) {
+    char buf[NET_RESPONSE_BUF_SIZE];
+    const int len = snprintf(buf, sizeof(buf), "[SERVER]: %s", msg);
+    send_or_queue(client_fd, buf, len < (int) sizeof(buf) ? (size_t) len : sizeof(buf) - 1);
+}
+
+void tcp_server_send_raw(const int client_fd, const char *msg) {
+    send_or_queue(client_fd, msg, strlen(msg));
 }
 
 void tcp_server_cleanup(TcpServer *svr) {
+    pthread_mutex_lock(&out_mutex);
+    server = NULL;
+    pthread_mutex_unlock(&out_mutex);
     for (int i = 0; i <= MAX_CLIENTS; i++) {
         if (svr->poll_fds[i].fd != -1) {
             close(svr->poll_fds[i].fd);
             svr->poll_fds[i].fd = -1;
         }
     }
+    if (record_file) {
+        fclose(record_file);
+        record_file = NULL;
+    }
 }
@@ -0,0 +1,260 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <errno.h>
+#include <unistd.h>
+#include "constants.h"
+#include "topology.h"
+
+#define SYSFS_CPU_DIR "/sys/devices/system/cpu"
+#define SYSFS_NODE_DIR "/sys/devices/system/node"
+#define PROC_IRQ_DIR "/proc/irq"
+#define MAX_REPORTED_IRQS 16
+
+void topology_init(Topology *topo) {
+    topo->task_cpu = CPU_NUMBER;
+    CPU_ZERO(&topo->control_cpus);
+    topo->control_set = false;
+    topo->task_node = -1;
+}
+
+int topology_parse_cpulist(const char *list, cpu_set_t *out) {
+    CPU_ZERO(out);
+    const char *p = list;
+    while (*p != '\0' && *p != '\n') {
+        char *end;
+        const long first = strtol(p, &end, 10);
+        if (end == p || first < 0 || first >= CPU_SETSIZE) return -1;
+        long last = first;
+        p = end;
+        if (*p == '-') {
+            last = strtol(p + 1, &end, 10);
+            if (end == p + 1 || last < first || last >= CPU_SETSIZE) return -1;
+            p = end;
+        }
+        for (long cpu = first; cpu <= last; cpu++) CPU_SET(cpu, out);
+        if (*p == ',') p++;
+        else if (*p != '\0' && *p != '\n') return -1;
+    }
+    return 0;
+}
+
+int topology_parse_cpu(const char *text, int *out) {
+    char *end;
+    errno = 0;
+    const long cpu = strtol(text, &end, 10);
+    if (end == text || *end != '\0' || errno != 0 || cpu < 0 || cpu >= CPU_SETSIZE) return -1;
+    *out = (int) cpu;
+    return 0;
+}
+
+/*
+ * Reads a sysfs/procfs cpulist file.
+ * Returns 0 on success, -1 if the file is missing or malformed.
+ */
+static int read_cpulist_file(const char *path, cpu_set_t *out) {
+    char buf[1024] = {0};
+    FILE *f = fopen(path, "r");
+    if (!f) return -1;
+    const int ok = fgets(buf, sizeof(buf), f) != NULL;
+    fclose(f);
+    if (!ok) {
+        CPU_ZERO(out); // Empty file: empty set
+        return 0;
+    }
+    return topology_parse_cpulist(buf, out);
+}
+
+static char *trim(char *s) {
+    while (*s == ' ' || *s == '\t') s++;
+    char *end = s + strlen(s);
+    while (end > s && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\n' || end[-1] == '\r')) end--;
+    *end = '\0';
+    return s;
+}
+
+int topology_load_file(Topology *topo, const char *path) {
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        perror("[Topology] Failed to open config file");
+        return -1;
+    }
+
+    char line[256];
+    int line_no = 0;
+    int err = 0;
+    while (!err && fgets(line, sizeof(line), f)) {
+        line_no++;
+        char *key = trim(line);
+        if (*key == '\0' || *key == '#') continue;
+
+        char *eq = strchr(key, '=');
+        if (!eq) {
+            err = -1;
+            break;
+        }
+        *eq = '\0';
+        char *value = trim(eq + 1);
+        key = trim(key);
+
+        if (strcmp(key, "task_cpu") == 0) {
+            if (topology_parse_cpu(value, &topo->task_cpu) != 0) err = -1;
+        } else if (strcmp(key, "control_cpus") == 0) {
+            if (topology_parse_cpulist(value, &topo->control_cpus) != 0) err = -1;
+            topo->control_set = true;
+        } else {
+            err = -1;
+        }
+    }
+    fclose(f);
+
+    if (err) fprintf(stderr, "[Topology] %s:%d: invalid entry\n", path, line_no);
+    return err;
+}
+
+/*
+ * Returns the NUMA node owning 'cpu', or -1 if the host exposes no node information.
+ */
+static int cpu_node(const int cpu) {
+    DIR *dir = opendir(SYSFS_NODE_DIR);
+    if (!dir) return -1;
+
+    int node = -1;
+    const struct dirent *entry;
+    while (node == -1 && (entry = readdir(dir)) != NULL) {
+        int id;
+        if (sscanf(entry->d_name, "node%d", &id) != 1) continue;
+
+        char path[512];
+        cpu_set_t cpus;
+        snprintf(path, sizeof(path), SYSFS_NODE_DIR "/%s/cpulist", entry->d_name);
+        if (read_cpulist_file(path, &cpus) == 0 && CPU_ISSET(cpu, &cpus)) node = id;
+    }
+    closedir(dir);
+    return node;
+}
+
+int topology_resolve(Topology *topo) {
+    cpu_set_t online;
+    if (read_cpulist_file(SYSFS_CPU_DIR "/online", &online) != 0) {
+        CPU_ZERO(&online);
+        const long n = sysconf(_SC_NPROCESSORS_ONLN);
+        for (long cpu = 0; cpu < n && cpu < CPU_SETSIZE; cpu++) CPU_SET(cpu, &online);
+    }
+
+    if (topo->task_cpu < 0 || topo->task_cpu >= CPU_SETSIZE || !CPU_ISSET(topo->task_cpu, &online)) {
+        fprintf(stderr, "[Topology] Task CPU %d is not online\n", topo->task_cpu);
+        return -1;
+    }
+    topo->task_node = cpu_node(topo->task_cpu);
+
+    if (topo->control_set) {
+        CPU_AND(&topo->control_cpus, &topo->control_cpus, &online);
+        if (CPU_COUNT(&topo->control_cpus) == 0) {
+            fprintf(stderr, "[Topology] No online control CPU configured\n");
+            return -1;
+        }
+        return 0;
+    }
+
+    // Default: housekeeping on the task core's NUMA node, keeping the task core exclusive
+    CPU_ZERO(&topo->control_cpus);
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (cpu == topo->task_cpu || !CPU_ISSET(cpu, &online)) continue;
+        if (topo->task_node != -1 && cpu_node(cpu) != topo->task_node) continue;
+        CPU_SET(cpu, &topo->control_cpus);
+    }
+    if (CPU_COUNT(&topo->control_cpus) == 0) CPU_SET(topo->task_cpu, &topo->control_cpus);
+    return 0;
+}
+
+bool topology_control_shares_task_cpu(const Topology *topo) {
+    return CPU_ISSET(topo->task_cpu, &topo->control_cpus);
+}
+
+static void format_cpulist(const cpu_set_t *set, char *buf, const size_t len) {
+    size_t off = 0;
+    buf[0] = '\0';
+    for (int cpu = 0; cpu < CPU_SETSIZE && off < len; cpu++) {
+        if (!CPU_ISSET(cpu, set)) continue;
+        int last = cpu;
+        while (last + 1 < CPU_SETSIZE && CPU_ISSET(last + 1, set)) last++;
+        if (last == cpu) off += snprintf(buf + off, len - off, "%s%d", off ? "," : "", cpu);
+        else off += snprintf(buf + off, len - off, "%s%d-%d", off ? "," : "", cpu, last);
+        cpu = last;
+    }
+}
+
+static void report_irqs(const int task_cpu) {
+    DIR *dir = opendir(PROC_IRQ_DIR);
+    if (!dir) {
+        printf("[Topology] IRQ affinity: %s not readable\n", PROC_IRQ_DIR);
+        return;
+    }
+
+    int hits = 0;
+    char listed[256] = {0};
+    size_t off = 0;
+    const struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        char *end;
+        const long irq = strtol(entry->d_name, &end, 10);
+        if (*end != '\0' || end == entry->d_name) continue;
+
+        char path[512];
+        cpu_set_t affinity;
+        snprintf(path, sizeof(path), PROC_IRQ_DIR "/%s/smp_affinity_list", entry->d_name);
+        if (read_cpulist_file(path, &affinity) != 0 || !CPU_ISSET(task_cpu, &affinity)) continue;
+
+        if (hits < MAX_REPORTED_IRQS && off < sizeof(listed)) {
+            off += snprintf(listed + off, sizeof(listed) - off, "%s%ld", hits ? "," : "", irq);
+        }
+        hits++;
+    }
+    closedir(dir);
+
+    if (hits == 0) {
+        printf("[Topology] IRQ affinity: no IRQ routed to CPU %d\n", task_cpu);
+    } else {
+        printf("[Topology] WARNING: %d IRQ(s) may run on task CPU %d (%s%s)\n",
+               hits, task_cpu, listed, hits > MAX_REPORTED_IRQS ? ",..." : "");
+    }
+}
+
+static void report_cpu_flag(const char *name, const int task_cpu) {
+    char path[256];
+    cpu_set_t set;
+    snprintf(path, sizeof(path), SYSFS_CPU_DIR "/%s", name);
+    if (read_cpulist_file(path, &set) != 0) {
+        printf("[Topology] %s: not supported by this kernel\n", name);
+    } else if (CPU_ISSET(task_cpu, &set)) {
+        printf("[Topology] %s: CPU %d OK\n", name, task_cpu);
+    } else {
+        printf("[Topology] WARNING: task CPU %d is not in %s\n", task_cpu, name);
+    }
+}
+
+void topology_report(const Topology *topo) {
+    char control[256];
+    format_cpulist(&topo->control_cpus, control, sizeof(control));
+    printf("[Topology] Tasks on CPU %d (node %d), control plane on CPUs %s\n",
+           topo->task_cpu, topo->task_node, control);
+
+    if (topology_control_shares_task_cpu(topo)) {
+        printf("[Topology] WARNING: control-plane threads share the task CPU and can preempt tasks\n");
+    }
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (!CPU_ISSET(cpu, &topo->control_cpus)) continue;
+        const int node = cpu_node(cpu);
+        if (topo->task_node != -1 && node != -1 && node != topo->task_node) {
+            printf("[Topology] WARNING: control CPU %d is on node %d, tasks on node %d\n",
+                   cpu, node, topo->task_node);
+        }
+    }
+
+    report_cpu_flag("isolated", topo->task_cpu);
+    report_cpu_flag("nohz_full", topo->task_cpu);
+    report_irqs(topo->task_cpu);
+}
@@ -0,0 +1,121 @@
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <unistd.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <time.h>
+#include "task_config.h"
+#include "trace.h"
+
+#define TRACE_RING_SIZE 4096
+
+typedef struct {
+    atomic_ullong head; // Records written since the last trace_start(), give or take one in progress at the reset
+    TraceRecord records[TRACE_RING_SIZE];
+    unsigned int generations[TRACE_RING_SIZE]; // trace_start() count when each record was written
+} TraceRing;
+
+static TraceRing rings[TRACE_RING_COUNT];
+static atomic_bool enabled = false;
+static atomic_uint generation;
+static char trace_dir[PATH_MAX] = ".";
+
+void trace_start(void) {
+    atomic_store(&enabled, false);
+    for (int i = 0; i < TRACE_RING_COUNT; i++) atomic_store(&rings[i].head, 0);
+    // A writer between its head load and store can undo the reset: its record and the
+    // stale ones below its head keep the old generation, so dumps leave them out
+    atomic_fetch_add_explicit(&generation, 1, memory_order_release);
+    atomic_store(&enabled, true);
+}
+
+void trace_stop(void) {
+    atomic_store(&enabled, false);
+}
+
+uint64_t trace_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+}
+
+void trace_record(const int ring, const TraceEventType type, const int task, const int instance_id,
+                  const int64_t arg, const uint64_t ts_ns) {
+    if (!atomic_load_explicit(&enabled, memory_order_relaxed)) return;
+
+    TraceRing *r = &rings[ring];
+    const unsigned int gen = atomic_load_explicit(&generation, memory_order_acquire);
+    const unsigned long long head = atomic_load_explicit(&r->head, memory_order_relaxed);
+    TraceRecord *rec = &r->records[head % TRACE_RING_SIZE];
+    r->generations[head % TRACE_RING_SIZE] = gen;
+    rec->ts_ns = ts_ns;
+    rec->type = (uint16_t) type;
+    rec->task = (uint16_t) task;
+    rec->instance_id = instance_id;
+    rec->arg = arg;
+    atomic_store_explicit(&r->head, head + 1, memory_order_release);
+}
+
+void trace_set_dir(const char *dir) {
+    snprintf(trace_dir, sizeof(trace_dir), "%s", dir);
+}
+
+long trace_dump(const char *name) {
+    static TraceRecord copy[TRACE_RING_SIZE];
+    static unsigned int copy_generations[TRACE_RING_SIZE];
+    char path[PATH_MAX + TRACE_PATH_LEN];
+
+    if (name[0] == '\0' || strchr(name, '/') || strcmp(name, ".") == 0 || strcmp(name, "..") == 0) return -1;
+    snprintf(path, sizeof(path), "%s/%s", trace_dir, name);
+    const int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_NOFOLLOW | O_CLOEXEC, 0644);
+    if (fd < 0) return -1;
+    FILE *f = fdopen(fd, "wb");
+    if (!f) {
+        close(fd);
+        return -1;
+    }
+
+    TraceFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, TRACE_MAGIC, sizeof(header.magic));
+    header.version = TRACE_VERSION;
+    header.task_count = N_TASKS;
+    for (int i = 0; i < N_TASKS; i++) {
+        strncpy(header.task_names[i], tasks_config.tasks[i].name, TASK_NAME_LEN - 1);
+    }
+    fwrite(&header, sizeof(header), 1, f); // Record count patched at the end
+
+    const unsigned int current = atomic_load_explicit(&generation, memory_order_acquire);
+    long total = 0;
+    for (int i = 0; i < TRACE_RING_COUNT; i++) {
+        const TraceRing *r = &rings[i];
+        const unsigned long long end = atomic_load_explicit(&r->head, memory_order_acquire);
+        unsigned long long begin = end > TRACE_RING_SIZE ? end - TRACE_RING_SIZE : 0;
+
+        for (unsigned long long k = begin; k < end; k++) {
+            copy[k - begin] = r->records[k % TRACE_RING_SIZE];
+            copy_generations[k - begin] = r->generations[k % TRACE_RING_SIZE];
+        }
+
+        // Drop the oldest records the writer may have overwritten during the copy
+        const unsigned long long after = atomic_load_explicit(&r->head, memory_order_acquire);
+        const unsigned long long first_valid = after > TRACE_RING_SIZE ? after - TRACE_RING_SIZE : 0;
+        const unsigned long long skip = first_valid > begin ? first_valid - begin : 0;
+        if (skip >= end - begin) continue;
+
+        for (unsigned long long k = skip; k < end - begin; k++) {
+            if (copy_generations[k] != current) continue; // Written before the last trace_start()
+            fwrite(&copy[k], sizeof(TraceRecord), 1, f);
+            total++;
+        }
+    }
+
+    header.record_count = (uint64_t) total;
+    fseek(f, 0, SEEK_SET);
+    fwrite(&header, sizeof(header), 1, f);
+    const int err = ferror(f);
+    fclose(f);
+    return err ? -1 : total;
+}
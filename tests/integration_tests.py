@@ -1,6 +1,13 @@
+import json
+import os
+import re
 import socket
+import struct
+import subprocess
 import sys
-from test_utils import run_test_isolated, send_command, log, HOST, PORT
+import tempfile
+import time
+from test_utils import run_test_isolated, send_command, log, get_server_command, wait_for_server, HOST, PORT
 
 def test_protocol_failure_injection():
     """
@@ -112,11 +119,681 @@ def test_dynamic_stress():
         log(f"Exception: {e}")
         return False
 
+def test_staggered_offsets():
+    """
+    Activates four t1 instances with staggered release offsets.
+    Synchronous RTA rejects the fourth (R=200 > D=150); the offset-aware test must admit it.
+    """
+    try:
+        sock = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+        sock.settimeout(5.0)
+        sock.connect((HOST, PORT))
+
+        for offset in (0, 75, 150, 225):
+            resp = send_command(sock, f"ACTIVATE t1 {offset}")
+            if "OK" not in resp:
+                log(f"Fail: Offset {offset} rejected. Resp: {resp}")
+                return False
+
+        resp = send_command(sock, "LIST")
+        if "O=225" not in resp:
+            log(f"Fail: Offset missing from LIST. Resp: {resp}")
+            return False
+
+        resp = send_command(sock, "ACTIVATE t1 -5")
+        if "ERR" not in resp:
+            log(f"Fail: Expected ERR for negative offset, got '{resp}'")
+            return False
+
+        sock.close()
+        return True
+    except Exception as e:
+        log(f"Exception: {e}")
+        return False
+
+def test_metrics_counters():
+    """
+    Verifies METRICS reports admissions and rejections by reason in Prometheus text format.
+    """
+    try:
+        sock = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+        sock.settimeout(5.0)
+        sock.connect((HOST, PORT))
+
+        send_command(sock, "ACTIVATE t1")
+        send_command(sock, "ACTIVATE nope")
+
+        sock.sendall(b"METRICS\n")
+        resp = sock.recv(8192).decode()
+        sock.close()
+        log(f"Metrics: {resp}")
+
+        expected = [
+            "dpt_admissions_total 1",
+            'dpt_admission_rejections_total{reason="unknown_task"} 1',
+            "dpt_active_instances 1",
+            "# TYPE dpt_event_queue_high_water gauge",
+        ]
+        for line in expected:
+            if line not in resp:
+                log(f"Fail: Missing '{line}'")
+                return False
+        return True
+    except Exception as e:
+        log(f"Exception: {e}")
+        return False
+
+def test_trace_dump():
+    """
+    Records a short trace, dumps it and converts it to Chrome trace JSON.
+    Dumps are confined to the trace directory (here the working directory).
+    """
+    trace_path = "trace_test.bin"
+    json_path = os.path.abspath("trace_test.json")
+    try:
+        sock = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+        sock.settimeout(5.0)
+        sock.connect((HOST, PORT))
+
+        if "OK" not in send_command(sock, "TRACE START"):
+            return False
+        if "OK" not in send_command(sock, "ACTIVATE t1"):
+            return False
+        time.sleep(1.0)
+        send_command(sock, "TRACE STOP")
+        for outside in ("/tmp/trace_test.bin", "../trace_test.bin", ".."):
+            if "Invalid Command" not in send_command(sock, f"TRACE DUMP {outside}"):
+                log(f"Fail: Dump outside the trace directory accepted: {outside}")
+                return False
+        resp = send_command(sock, f"TRACE DUMP {trace_path}")
+        sock.close()
+        if "records" not in resp:
+            log(f"Fail: Dump failed. Resp: {resp}")
+            return False
+
+        subprocess.run(["./dpt_trace2json", trace_path, json_path], check=True)
+        with open(json_path) as f:
+            events = json.load(f)["traceEvents"]
+
+        jobs = [e for e in events if e["ph"] == "X" and e["name"] == "t1"]
+        admits = [e for e in events if e["name"] == "admit t1"]
+        log(f"Trace: {len(events)} events, {len(jobs)} jobs")
+        return len(jobs) >= 2 and len(admits) == 1
+    except Exception as e:
+        log(f"Exception: {e}")
+        return False
+
+def test_elastic_compression():
+    """
+    Overloads the set so that only compressed periods fit, then verifies
+    the elastic tasks return to their nominal periods once the load drops.
+    """
+    try:
+        sock = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+        sock.settimeout(5.0)
+        sock.connect((HOST, PORT))
+
+        ids = []
+        for task in ("t3", "t3", "t3", "t1", "t2"):
+            resp = send_command(sock, f"ACTIVATE {task}")
+            if "ID=" not in resp:
+                log(f"Fail: {task} rejected. Resp: {resp}")
+                return False
+            ids.append(resp.split("ID=")[1].strip())
+
+        resp = send_command(sock, "LIST")
+        if "T=300" in resp:
+            log(f"Fail: t1 not compressed. Resp: {resp}")
+            return False
+
+        send_command(sock, f"DEACTIVATE {ids[-1]}")
+        resp = send_command(sock, "LIST")
+        sock.close()
+        if "t1 (C=50, T=300" not in resp:
+            log(f"Fail: Periods not expanded back. Resp: {resp}")
+            return False
+        return True
+    except Exception as e:
+        log(f"Exception: {e}")
+        return False
+
+def test_list_pagination():
+    """
+    Pages through the active set with LIST <offset> <limit>.
+    Verifies every page is a consistent slice of the same snapshot version.
+    """
+    try:
+        sock = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+        sock.settimeout(5.0)
+        sock.connect((HOST, PORT))
+
+        for offset in (0, 75, 150):
+            send_command(sock, f"ACTIVATE t1 {offset}")
+
+        full = send_command(sock, "LIST")
+        page1 = send_command(sock, "LIST 0 2")
+        page2 = send_command(sock, "LIST 2 2")
+        bad = send_command(sock, "LIST -1")
+        # Offsets and limits near LONG_MAX must not wrap the page bounds
+        huge_limit = send_command(sock, "LIST 1 9223372036854775807")
+        huge_offset = send_command(sock, "LIST 9223372036854775807 1")
+        sock.close()
+
+        if "Running: 3 (version" not in full or full.count("[ID") != 3:
+            log(f"Fail: Unexpected full list: {full}")
+            return False
+        if page1.count("[ID") != 2 or "next offset 2" not in page1:
+            log(f"Fail: Unexpected first page: {page1}")
+            return False
+        if page2.count("[ID") != 1 or "next offset" in page2:
+            log(f"Fail: Unexpected second page: {page2}")
+            return False
+        if page1.split("\n")[0] != page2.split("\n")[0]:
+            log("Fail: Pages come from different snapshot versions")
+            return False
+        if huge_limit.count("[ID") != 2 or "next offset" in huge_limit:
+            log(f"Fail: Unexpected page for a huge limit: {huge_limit}")
+            return False
+        if "[ID" in huge_offset or "next offset" in huge_offset:
+            log(f"Fail: Unexpected page past the end: {huge_offset}")
+            return False
+        return "ERR" in bad
+    except Exception as e:
+        log(f"Exception: {e}")
+        return False
+
+def test_aperiodic_server():
+    """
+    Submits aperiodic jobs next to a periodic load served by a deferrable server.
+    Verifies jobs are accepted, completed and counted, and oversized jobs are refused.
+    """
+    try:
+        sock = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+        sock.settimeout(5.0)
+        sock.connect((HOST, PORT))
+
+        send_command(sock, "ACTIVATE t1")
+        for _ in range(3):
+            resp = send_command(sock, "SUBMIT t1")
+            if "JOB=" not in resp:
+                log(f"Fail: SUBMIT refused. Resp: {resp}")
+                return False
+
+        resp = send_command(sock, "SUBMIT t3")
+        if "ERR" not in resp:
+            log(f"Fail: Job above the server budget accepted. Resp: {resp}")
+            return False
+
+        time.sleep(1.5)
+        resp = send_command(sock, "INFO")
+        sock.close()
+        if "done=3" not in resp:
+            log(f"Fail: Aperiodic jobs not completed. Resp: {resp}")
+            return False
+        return True
+    except Exception as e:
+        log(f"Exception: {e}")
+        return False
+
+test_aperiodic_server.server_args = ["--server-budget", "100", "--server-period", "400"]
+
+def test_cyclic_mode():
+    """
+    Runs the cyclic executive: admits a set that packs into frames, refuses a job
+    longer than any usable frame, and checks jobs run without deadline misses.
+    """
+    try:
+        sock = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+        sock.settimeout(5.0)
+        sock.connect((HOST, PORT))
+
+        for spec in ["t1", "t1 100", "t1 200"]:
+            resp = send_command(sock, f"ACTIVATE {spec}")
+            if "ID=" not in resp:
+                log(f"Fail: ACTIVATE {spec} refused in cyclic mode. Resp: {resp}")
+                return False
+
+        resp = send_command(sock, "ACTIVATE t3")
+        if "ERR" not in resp:
+            log(f"Fail: Set without a cyclic table admitted. Resp: {resp}")
+            return False
+
+        time.sleep(2.0)
+        sock.sendall(b"METRICS\n")
+        resp = sock.recv(8192).decode()
+        sock.close()
+
+        if "dpt_deadline_misses_total 0" not in resp or "dpt_jobs_total 0" in resp:
+            log(f"Fail: Cyclic executive missed deadlines or ran no jobs. Resp: {resp}")
+            return False
+        return True
+    except Exception as e:
+        log(f"Exception: {e}")
+        return False
+
+test_cyclic_mode.server_args = ["--mode", "cyclic"]
+
+STATE_PATH = os.path.join(tempfile.gettempdir(), f"dpt_state_{os.getpid()}.bin")
+
+def test_warm_restart():
+    """
+    Checkpoints an active set, shuts down and starts a second server on the
+    same state file. Verifies IDs, offsets and periods survive the restart
+    and that restored IDs are not handed out again.
+    """
+    second = None
+    try:
+        sock = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+        sock.settimeout(5.0)
+        sock.connect((HOST, PORT))
+
+        for spec in ["t1", "t2 37", "t3"]:
+            if "ID=" not in send_command(sock, f"ACTIVATE {spec}"):
+                return False
+        send_command(sock, "DEACTIVATE 1")
+        before = [l for l in send_command(sock, "LIST").split("\n") if "[ID" in l]
+        send_command(sock, "SHUTDOWN")
+        sock.close()
+
+        # Wait for the first server to release the port
+        deadline = time.time() + 10.0
+        while wait_for_server(0.2) and time.time() < deadline:
+            time.sleep(0.2)
+
+        second = subprocess.Popen(get_server_command() + ["--state-file", STATE_PATH],
+                                  stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+        if not wait_for_server(20.0):
+            log("Fail: Restarted server did not come up")
+            return False
+        time.sleep(1.0)
+
+        sock = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+        sock.settimeout(5.0)
+        sock.connect((HOST, PORT))
+        after = [l for l in send_command(sock, "LIST").split("\n") if "[ID" in l]
+        resp = send_command(sock, "ACTIVATE t1 10")
+        sock.close()
+
+        if len(before) != 2 or after != before:
+            log(f"Fail: Active set not restored. Before: {before} After: {after}")
+            return False
+        if "ID=4" not in resp:
+            log(f"Fail: Expected the next fresh ID after a restart. Resp: {resp}")
+            return False
+        return True
+    except Exception as e:
+        log(f"Exception: {e}")
+        return False
+    finally:
+        if second:
+            second.terminate()
+            try:
+                second.wait(timeout=3)
+            except subprocess.TimeoutExpired:
+                second.kill()
+        if os.path.exists(STATE_PATH):
+            os.unlink(STATE_PATH)
+
+test_warm_restart.server_args = ["--state-file", STATE_PATH]
+
+TRACE_HEADER = struct.Struct("<8sIIQ" + "32s" * 4)  # TraceFileHeader with N_TASKS names
+TRACE_RECORD = struct.Struct("<QHHiq")
+TRACE_START, TRACE_END = 2, 3
+
+def read_trace(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    count = TRACE_HEADER.unpack_from(data)[3]
+    return [TRACE_RECORD.unpack_from(data, TRACE_HEADER.size + i * TRACE_RECORD.size) for i in range(count)]
+
+def cancel_mid_job(task, period_ns, trace_path, reactivate=False):
+    """
+    Activates 'task', sends DEACTIVATE halfway through one of its jobs and
+    checks the reply is quick, the job is cut short and counted as cancelled.
+    With 'reactivate', activates it again at once and checks the cancelled
+    job stays cancelled while the new instance runs.
+    """
+    try:
+        # The client must preempt the running job, as a controller above the task priorities would
+        os.sched_setscheduler(0, os.SCHED_FIFO, os.sched_param(95))
+    except (AttributeError, PermissionError) as e:
+        log(f"Skipped: cannot run the client under SCHED_FIFO ({e})")
+        return True
+    try:
+        sock = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+        sock.settimeout(5.0)
+        sock.connect((HOST, PORT))
+
+        send_command(sock, "TRACE START")
+        if "ID=1" not in send_command(sock, f"ACTIVATE {task}"):
+            return False
+        records = []
+        for _ in range(30):
+            time.sleep(0.1)
+            send_command(sock, f"TRACE DUMP {trace_path}")
+            records = read_trace(trace_path)
+            if any(r[1] == TRACE_END for r in records):
+                break
+        starts = [r[0] for r in records if r[1] == TRACE_START]
+        ends = [r[4] for r in records if r[1] == TRACE_END]
+        if not ends:
+            log("Fail: No job completed")
+            return False
+
+        # Trace timestamps are CLOCK_MONOTONIC, like time.monotonic(); aim halfway into the next job
+        job_ns = ends[0]
+        target = (max(starts) + period_ns + job_ns // 2) / 1e9
+        while time.monotonic() < target:
+            time.sleep(target - time.monotonic())
+        t0 = time.monotonic()
+        resp = send_command(sock, "DEACTIVATE 1")
+        elapsed_ms = (time.monotonic() - t0) * 1000
+        log(f"DEACTIVATE answered in {elapsed_ms:.2f} ms")
+        if reactivate:
+            if "ID=2" not in send_command(sock, f"ACTIVATE {task}"):
+                log("Fail: Reactivation refused")
+                return False
+            time.sleep(2 * period_ns / 1e9)
+
+        sock.sendall(b"METRICS\n")
+        metrics = ""
+        while not re.search(r"^dpt_jobs_cancelled_total \d+\n", metrics, re.M):
+            metrics += sock.recv(8192).decode()  # The exposition spans several segments
+        send_command(sock, f"TRACE DUMP {trace_path}")
+        sock.close()
+        records = read_trace(trace_path)
+        ends = [r[4] for r in records if r[1] == TRACE_END and r[3] == 1]
+        log(f"Last job ran {ends[-1] / 1e6:.2f} ms of {job_ns / 1e6:.2f} ms")
+
+        if "OK" not in resp or "dpt_jobs_cancelled_total 1" not in metrics:
+            log(f"Fail: Job not cancelled. Resp: {resp}")
+            return False
+        if reactivate and not any(r[1] == TRACE_END and r[3] == 2 for r in records):
+            log("Fail: The new instance ran no job")
+            return False
+        # A job run to completion would hold the reply for the other half of its length
+        return elapsed_ms < 20.0 and ends[-1] < job_ns * 3 // 4
+    except Exception as e:
+        log(f"Exception: {e}")
+        return False
+    finally:
+        os.sched_setscheduler(0, os.SCHED_OTHER, os.sched_param(0))
+        if os.path.exists(trace_path):
+            os.unlink(trace_path)
+
+def test_deactivate_cancels_job():
+    """
+    Deactivates t3 halfway through a job and verifies the job stops at
+    its next preemption point instead of running to completion.
+    """
+    return cancel_mid_job("t3", 1000000000, "trace_cancel.bin")
+
+def test_cyclic_deactivate_cancels_job():
+    """
+    Same in cyclic mode, where DEACTIVATE waits for the executive instead of
+    a join. Activating t3 again at once must not revive the cancelled job.
+    """
+    return cancel_mid_job("t3", 1000000000, "trace_cancel.bin", reactivate=True)
+
+test_cyclic_deactivate_cancels_job.server_args = ["--mode", "cyclic"]
+
+def test_mixed_criticality():
+    """
+    Admits HI instances of t4 by their C_LO in LO mode, and rejects the one
+    whose C_HI no longer fits in HI mode even though LO utilization is low.
+    """
+    try:
+        sock = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+        sock.settimeout(5.0)
+        sock.connect((HOST, PORT))
+
+        # HI mode: 2 x 40 ms fits the 100 ms deadline, 3 x 40 ms does not (LO mode: 3 x 20 ms)
+        for _ in range(2):
+            if "ID=" not in send_command(sock, "ACTIVATE t4"):
+                return False
+        if "Schedulability" not in send_command(sock, "ACTIVATE t4"):
+            log("Fail: Third t4 admitted despite its C_HI")
+            return False
+        # LO tasks are only charged until the switch
+        if "ID=" not in send_command(sock, "ACTIVATE t3"):
+            return False
+
+        sock.sendall(b"INFO\n")
+        info = ""
+        while "Overhead:" not in info:
+            info += sock.recv(4096).decode()
+        sock.sendall(b"METRICS\n")
+        metrics = ""
+        while not re.search(r"^dpt_criticality_mode \d+\n", metrics, re.M):
+            metrics += sock.recv(8192).decode()
+        sock.close()
+
+        if "t4: C=20 T=200 D=100 HI C_HI=40" not in info or "Criticality: LO mode" not in info:
+            log(f"Fail: INFO lacks criticality. Resp: {info}")
+            return False
+        return "dpt_criticality_mode 0" in metrics and "dpt_jobs_dropped_total 0" in metrics
+    except Exception as e:
+        log(f"Exception: {e}")
+        return False
+
+def test_criticality_mode_switch():
+    """
+    Every tenth job of t4 runs past its C_LO on the threads runtime: the
+    runtime must switch to HI mode, with no deadline missed.
+    """
+    try:
+        sock = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+        sock.settimeout(5.0)
+        sock.connect((HOST, PORT))
+
+        if "ID=" not in send_command(sock, "ACTIVATE t4") or "ID=" not in send_command(sock, "ACTIVATE t1"):
+            return False
+        switches = 0
+        metrics = ""
+        deadline = time.time() + 6.0
+        while switches == 0 and time.time() < deadline:
+            time.sleep(0.5)
+            sock.sendall(b"METRICS\n")
+            metrics = ""
+            while not re.search(r"^dpt_criticality_mode \d+\n", metrics, re.M):
+                metrics += sock.recv(8192).decode()
+            switches = int(re.search(r"^dpt_criticality_mode_switches_total (\d+)", metrics, re.M).group(1))
+        sock.close()
+
+        if switches == 0 or "dpt_deadline_misses_total 0" not in metrics:
+            log(f"Fail: Expected a switch to HI mode and no misses. Resp: {metrics}")
+            return False
+        return True
+    except Exception as e:
+        log(f"Exception: {e}")
+        return False
+
+def test_tenant_reservations():
+    """
+    Creates reservations on an admin connection and binds tenants to them
+    with the issued tokens. Verifies that only admins reserve, that a wrong
+    token binds nothing, that tenant tasks are admitted against the
+    reservation alone, that neither another tenant nor an unbound client can
+    stop them, that t3 jobs, longer than the 25 ms budget, are throttled
+    rather than missing deadlines, and that only an empty reservation is deleted.
+    """
+    try:
+        admin = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+        admin.settimeout(5.0)
+        admin.connect((HOST, PORT))
+        if "Permission Denied" not in send_command(admin, "RESERVE gold 25 100 2"):
+            log("Fail: RESERVE accepted without ADMIN")
+            return False
+        if "Permission Denied" not in send_command(admin, "ADMIN guess"):
+            log("Fail: Wrong admin token accepted")
+            return False
+        if send_command(admin, "ADMIN secret") != "[SERVER]: OK":
+            return False
+        if "Invalid Command" not in send_command(admin, "RESERVE gold 200 100"):
+            log("Fail: Budget above the period accepted")
+            return False
+        resp = send_command(admin, "RESERVE gold 25 100 2")
+        if not re.fullmatch(r"\[SERVER\]: OK TOKEN=[0-9a-f]{32}", resp):
+            log(f"Fail: RESERVE issued no token. Resp: {resp}")
+            return False
+        gold_token = resp.split("TOKEN=")[1]
+        if "Schedulability" not in send_command(admin, "RESERVE big 99 100"):
+            log("Fail: Reservations above the CPU admitted")
+            return False
+
+        tenant = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+        tenant.settimeout(5.0)
+        tenant.connect((HOST, PORT))
+        send_command(tenant, f"TENANT ghost {gold_token}")
+        if "Unknown Reservation" not in send_command(tenant, "ACTIVATE t3"):
+            return False
+        send_command(tenant, "TENANT gold 0123456789abcdef0123456789abcdef")
+        if "Unknown Reservation" not in send_command(tenant, "ACTIVATE t3"):
+            log("Fail: Tenant bound with a wrong token")
+            return False
+        send_command(tenant, f"TENANT gold {gold_token}")
+        resp = send_command(tenant, "ACTIVATE t3")
+        if "ID=" not in resp:
+            return False
+        tenant_id = resp.split("ID=")[1].split()[0]
+        # 2 x 200 ms per second exceeds the reservation, though the CPU has room for it
+        if "Schedulability" not in send_command(tenant, "ACTIVATE t3"):
+            log("Fail: Tenant admitted beyond its reservation")
+            return False
+        if "Permission Denied" not in send_command(tenant, "UNRESERVE gold"):
+            log("Fail: A tenant deleted a reservation")
+            return False
+        # The shared pool is still open to the other clients
+        if "ID=" not in send_command(admin, "ACTIVATE t3"):
+            return False
+
+        other = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+        other.settimeout(5.0)
+        other.connect((HOST, PORT))
+        if "Invalid ID" not in send_command(other, f"DEACTIVATE {tenant_id}"):
+            log("Fail: An unbound client stopped a tenant's instance")
+            return False
+        silver_token = send_command(admin, "RESERVE silver 10 100").split("TOKEN=")[-1]
+        send_command(other, f"TENANT silver {silver_token}")
+        if "Invalid ID" not in send_command(other, f"DEACTIVATE {tenant_id}"):
+            log("Fail: A tenant stopped another tenant's instance")
+            return False
+        other.close()
+
+        listing = send_command(admin, "LIST")
+        if f"[ID {tenant_id}] t3 (C=200, T=1000, O=0) in gold" not in listing:
+            log(f"Fail: LIST lacks the reservation. Resp: {listing}")
+            return False
+
+        time.sleep(2.5)
+        admin.sendall(b"INFO\n")
+        info = ""
+        while "Reservation silver" not in info:
+            info += admin.recv(4096).decode()
+        admin.sendall(b"METRICS\n")
+        metrics = ""
+        while not re.search(r"^dpt_reservations \d+\n", metrics, re.M):
+            metrics += admin.recv(8192).decode()
+        if "Reservation In Use" not in send_command(admin, "UNRESERVE gold"):
+            log("Fail: A reservation with instances deleted")
+            return False
+        if send_command(tenant, f"DEACTIVATE {tenant_id}") != "[SERVER]: OK":
+            return False
+        tenant.close()
+        if send_command(admin, "UNRESERVE gold") != "[SERVER]: OK":
+            return False
+        if "Unknown Reservation" not in send_command(admin, "UNRESERVE gold"):
+            return False
+        admin.close()
+
+        if "Reservation gold: C=25 T=100 | 1/2 instances" not in info:
+            log(f"Fail: INFO lacks the reservation. Resp: {info}")
+            return False
+        throttles = int(re.search(r"^dpt_budget_throttles_total (\d+)", metrics, re.M).group(1))
+        if throttles == 0 or "dpt_deadline_misses_total 0" not in metrics or "dpt_reservations 2" not in metrics:
+            log(f"Fail: Expected throttled jobs and no misses. Resp: {metrics}")
+            return False
+        return True
+    except Exception as e:
+        log(f"Exception: {e}")
+        return False
+
+test_tenant_reservations.server_args = ["--admin-token", "secret"]
+
+def test_reservation_release_order():
+    """
+    Runs two t3 members, released 10 ms apart, in a 50 ms / 100 ms
+    reservation, so both are throttled at every replenishment. Verifies from
+    the trace that no job starts while the other member's job is unfinished:
+    the earlier release completes first, as the FIFO test assumes.
+    """
+    trace_path = "trace_order.bin"
+    try:
+        sock = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+        sock.settimeout(5.0)
+        sock.connect((HOST, PORT))
+        send_command(sock, "ADMIN secret")
+        token = send_command(sock, "RESERVE pair 50 100 2").split("TOKEN=")[-1]
+        send_command(sock, f"TENANT pair {token}")
+        send_command(sock, "TRACE START")
+        for offset in (0, 10):
+            resp = send_command(sock, f"ACTIVATE t3 {offset}")
+            if "ID=" not in resp:
+                log(f"Fail: Member rejected. Resp: {resp}")
+                return False
+        time.sleep(3.5)
+        send_command(sock, f"TRACE DUMP {trace_path}")
+        sock.sendall(b"METRICS\n")
+        metrics = ""
+        while not re.search(r"^dpt_reservations \d+\n", metrics, re.M):
+            metrics += sock.recv(8192).decode()
+        sock.close()
+
+        records = [r for r in read_trace(trace_path) if r[1] in (TRACE_START, TRACE_END)]
+        records.sort(key=lambda r: (r[0], r[1] == TRACE_START))  # A job may start the instant the other ends
+        running = set()
+        for ts, kind, _, instance, _ in records:
+            if kind == TRACE_START:
+                if running:
+                    log(f"Fail: Instance {instance} started at {ts} while {running} had not finished")
+                    return False
+                running.add(instance)
+            else:
+                running.discard(instance)
+        ends = {r[3] for r in records if r[1] == TRACE_END}
+        throttles = int(re.search(r"^dpt_budget_throttles_total (\d+)", metrics, re.M).group(1))
+        if len(ends) != 2 or throttles == 0 or "dpt_deadline_misses_total 0" not in metrics:
+            log(f"Fail: Expected both members to complete throttled jobs without misses. Resp: {metrics}")
+            return False
+        return True
+    except Exception as e:
+        log(f"Exception: {e}")
+        return False
+    finally:
+        if os.path.exists(trace_path):
+            os.unlink(trace_path)
+
+test_reservation_release_order.server_args = ["--admin-token", "secret"]
+
 if __name__ == "__main__":
     tests = [
         test_protocol_failure_injection,
         test_schedulability_saturation,
-        test_dynamic_stress
+        test_dynamic_stress,
+        test_staggered_offsets,
+        test_metrics_counters,
+        test_trace_dump,
+        test_elastic_compression,
+        test_list_pagination,
+        test_aperiodic_server,
+        test_cyclic_mode,
+        test_warm_restart,
+        test_deactivate_cancels_job,
+        test_cyclic_deactivate_cancels_job,
+        test_mixed_criticality,
+        test_criticality_mode_switch,
+        test_tenant_reservations,
+        test_reservation_release_order
     ]
     passed = 0
     for t in tests:
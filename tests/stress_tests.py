@@ -1,7 +1,8 @@
 import socket
+import subprocess
 import time
 import sys
-from test_utils import run_test_isolated, log, HOST, PORT
+from test_utils import run_test_isolated, send_command, log, HOST, PORT
 
 def test_fuzzing_garbage():
     """
@@ -107,8 +108,106 @@ def test_rapid_churn_cycle():
         log(f"Churn Exception: {e}")
         return False
 
+def test_pipelined_commands():
+    """
+    Sends several commands in a single segment, the last one split across two.
+    Verifies every command gets its own response.
+    """
+    try:
+        sock = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+        sock.settimeout(5.0)
+        sock.connect((HOST, PORT))
+
+        sock.sendall(b"LIST\nINFO\nLI")
+        time.sleep(0.2)
+        sock.sendall(b"ST\n")
+
+        data = ""
+        deadline = time.time() + 5.0
+        while data.count("[SERVER]:") < 3 and time.time() < deadline:
+            chunk = sock.recv(4096)
+            if not chunk: break
+            data += chunk.decode()
+        sock.close()
+
+        log(f"Pipelined responses: {data.count('[SERVER]:')}")
+        return data.count("[SERVER]: Running:") == 2 and "Capacity:" in data
+    except Exception as e:
+        log(f"Exception: {e}")
+        return False
+
+def test_loadgen_closed_loop():
+    """
+    Runs the native load generator for a short closed-loop burst over several connections.
+    Verifies no command times out and no connection is dropped.
+    """
+    try:
+        result = subprocess.run(["./dpt_loadgen", "--connections", "4", "--duration", "2"],
+                                capture_output=True, text=True, timeout=30)
+        log(result.stdout)
+        return result.returncode == 0 and "Total:" in result.stdout
+    except Exception as e:
+        log(f"Exception: {e}")
+        return False
+
+def test_loadgen_shm():
+    """
+    Runs the same closed-loop mix over the shared-memory channel.
+    Verifies every typed request is answered and the instances are released.
+    """
+    try:
+        result = subprocess.run(["./dpt_loadgen", "--transport", "shm", "--shm-channel", "/dpt_stress",
+                                 "--connections", "4", "--duration", "2"],
+                                capture_output=True, text=True, timeout=30)
+        log(result.stdout)
+        if result.returncode != 0 or "over shared memory" not in result.stdout:
+            return False
+
+        sock = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+        sock.settimeout(5.0)
+        sock.connect((HOST, PORT))
+        resp = send_command(sock, "LIST")
+        sock.close()
+        return "Running: 0" in resp
+    except Exception as e:
+        log(f"Exception: {e}")
+        return False
+
+test_loadgen_shm.server_args = ["--shm-channel", "/dpt_stress"]
+
+def test_command_throttling():
+    """
+    Pipelines three intervals worth of commands against a small command budget.
+    Verifies every command is answered, none dropped, and that serving them
+    is spread over the following control intervals.
+    """
+    try:
+        sock = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+        sock.settimeout(5.0)
+        sock.connect((HOST, PORT))
+
+        start = time.time()
+        sock.sendall(b"LIST\n" * 60)
+        data = ""
+        deadline = start + 5.0
+        while data.count("[SERVER]:") < 60 and time.time() < deadline:
+            chunk = sock.recv(65536)
+            if not chunk: break
+            data += chunk.decode()
+        elapsed = time.time() - start
+        sock.close()
+
+        log(f"Throttled responses: {data.count('[SERVER]:')} in {elapsed:.2f}s")
+        return data.count("[SERVER]: Running:") == 60 and elapsed >= 0.1
+    except Exception as e:
+        log(f"Exception: {e}")
+        return False
+
+test_command_throttling.server_args = ["--command-budget", "20"]
+
 if __name__ == "__main__":
-    tests = [test_fuzzing_garbage, test_queue_overflow, test_rapid_churn_cycle]
+    tests = [test_fuzzing_garbage, test_queue_overflow, test_rapid_churn_cycle, test_pipelined_commands,
+             test_loadgen_closed_loop, test_loadgen_shm, test_command_throttling]
     passed = 0
     for t in tests:
         if run_test_isolated(t): passed += 1
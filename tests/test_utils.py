@@ -58,7 +58,8 @@ def send_command(sock, cmd):
 def run_test_isolated(test_func):
     log(f"Starting Server for {test_func.__name__}...")
 
-    cmd = get_server_command()
+    # Tests may request extra server options through a 'server_args' attribute
+    cmd = get_server_command() + list(getattr(test_func, "server_args", []))
     is_valgrind = "valgrind" in cmd[0]
 
     proc = subprocess.Popen(cmd, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
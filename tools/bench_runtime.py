@@ -0,0 +1,140 @@
+#!/usr/bin/env python3
+"""
+Compares the thread-per-instance runtime with the cyclic executive.
+
+Starts the server once per mode, activates the same task set, records a
+trace and counts the context switches of the whole process. Reports per
+instance the period jitter (deviation of consecutive job starts from the
+period) and the release-to-start latency, plus context switches per job.
+
+Usage: sudo python3 tools/bench_runtime.py [--server ./build/dynamic_periodic_task] [--seconds 10]
+"""
+import argparse
+import glob
+import os
+import socket
+import statistics
+import struct
+import subprocess
+import sys
+import time
+
+HOST = "127.0.0.1"
+PORT = 8080
+TASK_SET = ["t1 0", "t1 100", "t1 200"]
+
+RECORD = struct.Struct("<QHHiq")
+HEADER = struct.Struct("<8sIIQ")
+TRACE_RELEASE, TRACE_START = 1, 2
+
+
+def command(sock, line):
+    sock.sendall(f"{line}\n".encode())
+    return sock.recv(65536).decode()
+
+
+def context_switches(pid):
+    total = 0
+    for status in glob.glob(f"/proc/{pid}/task/*/status"):
+        try:
+            with open(status) as f:
+                for line in f:
+                    if line.startswith(("voluntary_ctxt_switches", "nonvoluntary_ctxt_switches")):
+                        total += int(line.split()[1])
+        except OSError:
+            pass # Thread exited while scanning
+    return total
+
+
+def read_trace(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    _, _, _, count = HEADER.unpack_from(data, 0)
+    base = len(data) - count * RECORD.size
+    return [RECORD.unpack_from(data, base + i * RECORD.size) for i in range(count)]
+
+
+def wait_for_port(timeout=5.0):
+    deadline = time.time() + timeout
+    while time.time() < deadline:
+        try:
+            socket.create_connection((HOST, PORT), timeout=0.5).close()
+            return True
+        except OSError:
+            time.sleep(0.1)
+    return False
+
+
+def run_mode(server, mode, seconds, trace_path):
+    trace_dir, trace_name = os.path.split(trace_path)
+    proc = subprocess.Popen([server, "--mode", mode, "--trace-dir", trace_dir], stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+    try:
+        if not wait_for_port():
+            sys.exit(f"server did not start in {mode} mode")
+        time.sleep(1.0) # CPU calibration
+
+        sock = socket.create_connection((HOST, PORT), timeout=5)
+        periods = {}
+        for spec in TASK_SET:
+            resp = command(sock, f"ACTIVATE {spec}")
+            if "ID=" not in resp:
+                sys.exit(f"{mode}: ACTIVATE {spec} refused: {resp.strip()}")
+            periods[int(resp.split("ID=")[1])] = None
+        for line in command(sock, "LIST").splitlines():
+            if "[ID" in line:
+                iid = int(line.split("[ID")[1].split("]")[0])
+                periods[iid] = int(line.split("T=")[1].split(",")[0])
+
+        time.sleep(1.0) # Let the first cycle start before measuring
+        command(sock, "TRACE START")
+        switches = context_switches(proc.pid)
+        time.sleep(seconds)
+        switches = context_switches(proc.pid) - switches
+        command(sock, f"TRACE DUMP {trace_name}")
+        command(sock, "SHUTDOWN")
+        sock.close()
+        proc.wait(timeout=5)
+    finally:
+        if proc.poll() is None:
+            proc.kill()
+
+    records = read_trace(trace_path)
+    os.unlink(trace_path)
+    starts, latency = {}, {}
+    release = {}
+    for ts, kind, _, iid, _ in sorted(records):
+        if kind == TRACE_RELEASE:
+            release[iid] = ts
+        elif kind == TRACE_START:
+            starts.setdefault(iid, []).append(ts)
+            if iid in release:
+                latency.setdefault(iid, []).append((ts - release[iid]) / 1e3)
+
+    rows, jobs = [], 0
+    for iid in sorted(starts):
+        s = starts[iid]
+        jobs += len(s)
+        jitter = [abs((b - a) / 1e3 - periods[iid] * 1e3) for a, b in zip(s, s[1:])]
+        rows.append((iid, len(s), statistics.mean(jitter) if jitter else 0, max(jitter, default=0),
+                     statistics.median(latency.get(iid, [0])), max(latency.get(iid, [0]))))
+    return rows, jobs, switches
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--server", default="./build/dynamic_periodic_task")
+    parser.add_argument("--seconds", type=float, default=10.0)
+    args = parser.parse_args()
+
+    for mode in ("threads", "cyclic"):
+        rows, jobs, switches = run_mode(args.server, mode, args.seconds, f"/tmp/dpt_bench_{mode}.bin")
+        print(f"\n== {mode} ==")
+        print(f"{'ID':>3} {'jobs':>6} {'jitter avg(us)':>15} {'jitter max(us)':>15} "
+              f"{'start lat p50(us)':>18} {'start lat max(us)':>18}")
+        for iid, n, j_avg, j_max, l_med, l_max in rows:
+            print(f"{iid:>3} {n:>6} {j_avg:>15.1f} {j_max:>15.1f} {l_med:>18.1f} {l_max:>18.1f}")
+        print(f"context switches: {switches} ({switches / jobs if jobs else 0:.2f} per job)")
+
+
+if __name__ == "__main__":
+    main()
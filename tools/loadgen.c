@@ -0,0 +1,678 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <time.h>
+#include <poll.h>
+#include <getopt.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include "constants.h"
+#include "shm_channel.h"
+
+/*
+ * Load generator for the command port. Every connection runs in its own
+ * thread and sends a weighted mix of ACTIVATE, DEACTIVATE, LIST and INFO,
+ * either closed-loop (next command after the previous answer) or open-loop
+ * (fixed send schedule, latency measured from the scheduled instant so a
+ * stalled server is not hidden by a stalled client).
+ * Responses are framed by their "[SERVER]: " prefix and matched to commands
+ * in order; the continuation lines of LIST and INFO are skipped.
+ * With --transport shm the same mix goes through the shared-memory channel
+ * as typed requests (closed loop only: one call in flight per worker).
+ */
+
+#define NSEC_PER_SEC 1000000000LL
+#define NSEC_PER_MSEC 1000000LL
+#define RESPONSE_PREFIX "[SERVER]: "
+#define RESPONSE_PREFIX_LEN (sizeof(RESPONSE_PREFIX) - 1)
+#define RECV_BUF_SIZE (4 * NET_RESPONSE_BUF_SIZE)
+#define MAX_ERROR_KINDS 8
+#define MAX_OWNED 1024
+#define MAX_OUTSTANDING 4096
+#define MAX_MIX_TASKS 8
+
+typedef enum {
+    CMD_ACTIVATE = 0,
+    CMD_DEACTIVATE,
+    CMD_LIST,
+    CMD_INFO,
+    CMD_TYPE_COUNT
+} CommandType;
+
+static const char *command_names[CMD_TYPE_COUNT] = {"ACTIVATE", "DEACTIVATE", "LIST", "INFO"};
+
+typedef struct {
+    char reason[32];
+    unsigned long long count;
+} ErrorKind;
+
+typedef struct {
+    long long *latency_ns;
+    size_t samples;
+    size_t capacity;
+    unsigned long long sent;
+    unsigned long long ok;
+    unsigned long long errors;
+    unsigned long long timeouts;
+    ErrorKind kinds[MAX_ERROR_KINDS];
+    int kind_count;
+} TypeStats;
+
+typedef struct {
+    const char *host;
+    int port;
+    int connections;
+    double duration_s;
+    int open_loop;
+    double rate;      // Commands per second over all connections (open loop)
+    int timeout_ms;
+    int weights[CMD_TYPE_COUNT];
+    char tasks[MAX_MIX_TASKS][TASK_NAME_LEN];
+    int task_count;
+    double max_p99_ms;
+    int shm;              // Shared-memory transport instead of TCP
+    const char *shm_name;
+} LoadOptions;
+
+typedef struct {
+    CommandType type;
+    long long sched_ns;
+} Outstanding;
+
+typedef struct {
+    int index;
+    const LoadOptions *opts;
+    pthread_t thread;
+    int fd;
+    unsigned int seed;
+    char buf[RECV_BUF_SIZE];
+    size_t len;
+    int owned[MAX_OWNED];
+    int owned_count;
+    int failed; // Connection refused, closed or timed out
+    long long finished_ns;
+    Outstanding queue[MAX_OUTSTANDING]; // Open loop: commands waiting for an answer, oldest first
+    TypeStats stats[CMD_TYPE_COUNT];
+} Worker;
+
+static ShmChannel *shm_channel; // Shared by all workers with --transport shm
+
+static long long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long) ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+static void record_latency(TypeStats *st, const long long ns) {
+    if (st->samples == st->capacity) {
+        st->capacity = st->capacity ? st->capacity * 2 : 1024;
+        st->latency_ns = realloc(st->latency_ns, st->capacity * sizeof(long long));
+        if (!st->latency_ns) {
+            perror("realloc");
+            exit(EXIT_FAILURE);
+        }
+    }
+    st->latency_ns[st->samples++] = ns;
+}
+
+static void record_error(TypeStats *st, const char *reason, const unsigned long long count) {
+    for (int i = 0; i < st->kind_count; i++) {
+        if (strcmp(st->kinds[i].reason, reason) == 0) {
+            st->kinds[i].count += count;
+            return;
+        }
+    }
+    if (st->kind_count < MAX_ERROR_KINDS) {
+        ErrorKind *kind = &st->kinds[st->kind_count++];
+        snprintf(kind->reason, sizeof(kind->reason), "%s", reason);
+        kind->count = count;
+        return;
+    }
+    st->kinds[MAX_ERROR_KINDS - 1].count += count; // Rare reasons share the last slot
+}
+
+static int connect_server(const LoadOptions *opts) {
+    const int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    struct sockaddr_in addr = {.sin_family = AF_INET, .sin_port = htons(opts->port)};
+    if (inet_pton(AF_INET, opts->host, &addr.sin_addr) != 1 ||
+        connect(fd, (struct sockaddr *) &addr, sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/*
+ * Extracts the first line of the next complete response into 'head'.
+ * @return 1 if a response was taken, 0 if more data is needed.
+ */
+static int take_response(Worker *w, char *head, const size_t size) {
+    char *p = memmem(w->buf, w->len, RESPONSE_PREFIX, RESPONSE_PREFIX_LEN);
+    if (!p) {
+        // Continuation lines of the previous response; keep a possibly split prefix
+        if (w->len >= RESPONSE_PREFIX_LEN) {
+            const size_t keep = RESPONSE_PREFIX_LEN - 1;
+            memmove(w->buf, w->buf + w->len - keep, keep);
+            w->len = keep;
+        }
+        return 0;
+    }
+
+    const size_t start = (size_t) (p - w->buf);
+    const char *nl = memchr(p, '\n', w->len - start);
+    if (!nl) {
+        memmove(w->buf, p, w->len - start);
+        w->len -= start;
+        return 0;
+    }
+
+    const char *body = p + RESPONSE_PREFIX_LEN;
+    size_t n = (size_t) (nl - body);
+    if (n >= size) n = size - 1;
+    memcpy(head, body, n);
+    head[n] = '\0';
+
+    const size_t consumed = (size_t) (nl + 1 - w->buf);
+    memmove(w->buf, nl + 1, w->len - consumed);
+    w->len -= consumed;
+    return 1;
+}
+
+/*
+ * Reads what is available, waiting at most 'timeout_ms'.
+ * @return 1 if data arrived, 0 on timeout, -1 if the connection is gone.
+ */
+static int fill_buffer(Worker *w, const int timeout_ms) {
+    struct pollfd pfd = {.fd = w->fd, .events = POLLIN};
+    const int ret = poll(&pfd, 1, timeout_ms);
+    if (ret == 0) return 0;
+    if (ret < 0) return -1;
+    if (w->len == sizeof(w->buf)) w->len = 0; // Oversized continuation, never part of a head
+    const ssize_t n = recv(w->fd, w->buf + w->len, sizeof(w->buf) - w->len, 0);
+    if (n <= 0) return -1;
+    w->len += (size_t) n;
+    return 1;
+}
+
+static CommandType pick_command(Worker *w) {
+    const int *weights = w->opts->weights;
+    int total = 0;
+    for (int i = 0; i < CMD_TYPE_COUNT; i++) total += weights[i];
+    int r = (int) (rand_r(&w->seed) % (unsigned) total);
+    CommandType type = CMD_ACTIVATE;
+    for (int i = 0; i < CMD_TYPE_COUNT; i++) {
+        if (r < weights[i]) {
+            type = (CommandType) i;
+            break;
+        }
+        r -= weights[i];
+    }
+    // Nothing of ours to stop yet: grow the set instead
+    if (type == CMD_DEACTIVATE && w->owned_count == 0) type = CMD_ACTIVATE;
+    return type;
+}
+
+/* Removes a random instance from the ones this worker owns and returns its ID. */
+static int take_owned(Worker *w) {
+    const int pick = (int) (rand_r(&w->seed) % (unsigned) w->owned_count);
+    const int id = w->owned[pick];
+    w->owned[pick] = w->owned[--w->owned_count];
+    return id;
+}
+
+static int send_command(Worker *w, const CommandType type) {
+    char line[64];
+    const LoadOptions *opts = w->opts;
+    switch (type) {
+        case CMD_ACTIVATE:
+            snprintf(line, sizeof(line), "ACTIVATE %s\n", opts->tasks[rand_r(&w->seed) % opts->task_count]);
+            break;
+        case CMD_DEACTIVATE:
+            snprintf(line, sizeof(line), "DEACTIVATE %d\n", take_owned(w));
+            break;
+        default:
+            snprintf(line, sizeof(line), "%s\n", command_names[type]);
+            break;
+    }
+    w->stats[type].sent++;
+    return send(w->fd, line, strlen(line), MSG_NOSIGNAL) == (ssize_t) strlen(line) ? 0 : -1;
+}
+
+static void complete_command(Worker *w, const CommandType type, const char *head, const long long latency_ns) {
+    TypeStats *st = &w->stats[type];
+    record_latency(st, latency_ns);
+    if (strncmp(head, "ERR", 3) == 0) {
+        st->errors++;
+        record_error(st, head[3] == ' ' ? head + 4 : head, 1);
+        return;
+    }
+    st->ok++;
+    int id;
+    const char *p = strstr(head, "ID=");
+    if (type == CMD_ACTIVATE && p && sscanf(p, "ID=%d", &id) == 1 && w->owned_count < MAX_OWNED) {
+        w->owned[w->owned_count++] = id;
+    }
+}
+
+/*
+ * One shared-memory call: the request is an Event, the answer a typed status.
+ * The text of LIST and INFO is copied out like a TCP client would receive it.
+ */
+static int call_shm(Worker *w, const CommandType type, const int target, ShmResult *res) {
+    Event ev;
+    memset(&ev, 0, sizeof(ev));
+    switch (type) {
+        case CMD_ACTIVATE:
+            ev.type = EV_ACTIVATE;
+            snprintf(ev.payload.activate.task_name, TASK_NAME_LEN, "%s",
+                     w->opts->tasks[rand_r(&w->seed) % w->opts->task_count]);
+            break;
+        case CMD_DEACTIVATE:
+            ev.type = EV_DEACTIVATE;
+            ev.payload.target_id = target;
+            break;
+        case CMD_LIST: ev.type = EV_LIST;
+            break;
+        default: ev.type = EV_INFO;
+            break;
+    }
+    return shm_client_call(shm_channel, &ev, res, w->buf, sizeof(w->buf), w->opts->timeout_ms);
+}
+
+static void complete_result(Worker *w, const CommandType type, const ShmResult *res, const long long latency_ns) {
+    TypeStats *st = &w->stats[type];
+    record_latency(st, latency_ns);
+    if (res->status != STATUS_OK) {
+        const char *text = event_status_text(res->status);
+        st->errors++;
+        record_error(st, strncmp(text, "ERR ", 4) == 0 ? text + 4 : text, 1);
+        return;
+    }
+    st->ok++;
+    if (type == CMD_ACTIVATE && w->owned_count < MAX_OWNED) w->owned[w->owned_count++] = (int) res->value;
+}
+
+static void run_closed_loop_shm(Worker *w, const long long end_ns) {
+    ShmResult res;
+    while (!w->failed && now_ns() < end_ns) {
+        const CommandType type = pick_command(w);
+        const int target = type == CMD_DEACTIVATE ? take_owned(w) : 0;
+        w->stats[type].sent++;
+        const long long t0 = now_ns();
+        if (call_shm(w, type, target, &res) != 0) {
+            w->stats[type].timeouts++;
+            w->failed = 1;
+            return;
+        }
+        complete_result(w, type, &res, now_ns() - t0);
+    }
+}
+
+static void run_closed_loop(Worker *w, const long long end_ns) {
+    char head[NET_RESPONSE_BUF_SIZE];
+    while (!w->failed && now_ns() < end_ns) {
+        const CommandType type = pick_command(w);
+        const long long t0 = now_ns();
+        if (send_command(w, type) != 0) {
+            w->failed = 1;
+            break;
+        }
+        const long long give_up = t0 + w->opts->timeout_ms * NSEC_PER_MSEC;
+        while (!take_response(w, head, sizeof(head))) {
+            const long long left = give_up - now_ns();
+            const int ret = left > 0 ? fill_buffer(w, (int) ((left + NSEC_PER_MSEC - 1) / NSEC_PER_MSEC)) : 0;
+            if (ret <= 0) {
+                if (ret == 0) w->stats[type].timeouts++;
+                w->failed = 1;
+                return;
+            }
+        }
+        complete_command(w, type, head, now_ns() - t0);
+    }
+}
+
+static void run_open_loop(Worker *w, const long long start_ns, const long long end_ns) {
+    Outstanding *queue = w->queue;
+    char head[NET_RESPONSE_BUF_SIZE];
+    const long long interval_ns = (long long) ((double) w->opts->connections * NSEC_PER_SEC / w->opts->rate);
+    // Spread the connections over one interval so they do not fire together
+    long long next_send = start_ns + interval_ns * w->index / w->opts->connections;
+    int head_idx = 0, count = 0;
+
+    while (!w->failed) {
+        const long long now = now_ns();
+        const int sending = now < end_ns;
+        if (!sending && count == 0) break;
+
+        while (sending && now >= next_send && count < MAX_OUTSTANDING) {
+            const CommandType type = pick_command(w);
+            if (send_command(w, type) != 0) {
+                w->failed = 1;
+                return;
+            }
+            queue[(head_idx + count) % MAX_OUTSTANDING] = (Outstanding){.type = type, .sched_ns = next_send};
+            count++;
+            next_send += interval_ns;
+        }
+
+        long long wait_ns = sending ? next_send - now : end_ns + w->opts->timeout_ms * NSEC_PER_MSEC - now;
+        if (wait_ns < 0) {
+            if (!sending) break; // Drain deadline passed
+            wait_ns = 0;
+        }
+        const int ret = fill_buffer(w, (int) ((wait_ns + NSEC_PER_MSEC - 1) / NSEC_PER_MSEC));
+        if (ret < 0) {
+            w->failed = 1;
+            break;
+        }
+        while (count > 0 && take_response(w, head, sizeof(head))) {
+            const Outstanding o = queue[head_idx];
+            head_idx = (head_idx + 1) % MAX_OUTSTANDING;
+            count--;
+            complete_command(w, o.type, head, now_ns() - o.sched_ns);
+        }
+    }
+    // Whatever is still in flight never got an answer
+    for (int i = 0; i < count; i++) w->stats[queue[(head_idx + i) % MAX_OUTSTANDING].type].timeouts++;
+}
+
+/*
+ * Stops the instances this connection activated, outside of the measurement.
+ */
+static void release_owned(Worker *w) {
+    char head[NET_RESPONSE_BUF_SIZE];
+    char line[32];
+    ShmResult res;
+    while (w->opts->shm && !w->failed && w->owned_count > 0) {
+        if (call_shm(w, CMD_DEACTIVATE, w->owned[--w->owned_count], &res) != 0) return;
+    }
+    while (!w->failed && w->owned_count > 0) {
+        snprintf(line, sizeof(line), "DEACTIVATE %d\n", w->owned[--w->owned_count]);
+        if (send(w->fd, line, strlen(line), MSG_NOSIGNAL) < 0) return;
+        while (!take_response(w, head, sizeof(head))) {
+            if (fill_buffer(w, w->opts->timeout_ms) <= 0) return;
+        }
+    }
+}
+
+static void *worker_entry(void *arg) {
+    Worker *w = arg;
+    w->fd = w->opts->shm ? -1 : connect_server(w->opts);
+    if (!w->opts->shm && w->fd < 0) {
+        w->failed = 1;
+        return NULL;
+    }
+    const long long start = now_ns();
+    const long long end = start + (long long) (w->opts->duration_s * NSEC_PER_SEC);
+    if (w->opts->shm) run_closed_loop_shm(w, end);
+    else if (w->opts->open_loop) run_open_loop(w, start, end);
+    else run_closed_loop(w, end);
+    w->finished_ns = now_ns();
+    release_owned(w);
+    if (w->fd >= 0) close(w->fd);
+    return NULL;
+}
+
+static int compare_ll(const void *a, const void *b) {
+    const long long x = *(const long long *) a;
+    const long long y = *(const long long *) b;
+    return (x > y) - (x < y);
+}
+
+static double percentile_ms(const long long *sorted, const size_t n, const double p) {
+    if (n == 0) return 0;
+    size_t idx = (size_t) (p * (double) n + 0.999999);
+    if (idx == 0) idx = 1;
+    if (idx > n) idx = n;
+    return (double) sorted[idx - 1] / NSEC_PER_MSEC;
+}
+
+/*
+ * Merges the per-connection statistics, prints the report and returns the overall p99.
+ */
+static double report(Worker *workers, const LoadOptions *opts, const double elapsed_s, int *failed) {
+    TypeStats total[CMD_TYPE_COUNT];
+    memset(total, 0, sizeof(total));
+    *failed = 0;
+
+    for (int i = 0; i < opts->connections; i++) {
+        const Worker *w = &workers[i];
+        *failed += w->failed;
+        for (int t = 0; t < CMD_TYPE_COUNT; t++) {
+            const TypeStats *s = &w->stats[t];
+            TypeStats *d = &total[t];
+            for (size_t k = 0; k < s->samples; k++) record_latency(d, s->latency_ns[k]);
+            d->sent += s->sent;
+            d->ok += s->ok;
+            d->errors += s->errors;
+            d->timeouts += s->timeouts;
+            for (int k = 0; k < s->kind_count; k++) record_error(d, s->kinds[k].reason, s->kinds[k].count);
+        }
+    }
+
+    printf("Load: %d connections over %s, %s loop", opts->connections, opts->shm ? "shared memory" : "TCP",
+           opts->open_loop ? "open" : "closed");
+    if (opts->open_loop) printf(" at %.1f cmd/s", opts->rate);
+    printf(", %.1f s\n\n", elapsed_s);
+    printf("%-11s %9s %9s %9s %8s %9s %9s %9s\n", "Command", "Sent", "OK", "ERR", "Timeout", "p50(ms)", "p99(ms)",
+           "p999(ms)");
+
+    TypeStats all = {0};
+    for (int t = 0; t < CMD_TYPE_COUNT; t++) {
+        TypeStats *s = &total[t];
+        if (s->sent == 0) continue;
+        qsort(s->latency_ns, s->samples, sizeof(long long), compare_ll);
+        printf("%-11s %9llu %9llu %9llu %8llu %9.3f %9.3f %9.3f\n", command_names[t], s->sent, s->ok, s->errors,
+               s->timeouts, percentile_ms(s->latency_ns, s->samples, 0.50),
+               percentile_ms(s->latency_ns, s->samples, 0.99), percentile_ms(s->latency_ns, s->samples, 0.999));
+        for (int k = 0; k < s->kind_count; k++) {
+            printf("  ERR %-24s %9llu (%.2f%%)\n", s->kinds[k].reason, s->kinds[k].count,
+                   100.0 * (double) s->kinds[k].count / (double) s->sent);
+        }
+        for (size_t k = 0; k < s->samples; k++) record_latency(&all, s->latency_ns[k]);
+        all.sent += s->sent;
+        all.errors += s->errors;
+        all.timeouts += s->timeouts;
+    }
+
+    qsort(all.latency_ns, all.samples, sizeof(long long), compare_ll);
+    const double p99 = percentile_ms(all.latency_ns, all.samples, 0.99);
+    printf("\nTotal: %zu answered, %.1f cmd/s, p50 %.3f ms, p99 %.3f ms, p999 %.3f ms\n",
+           all.samples, elapsed_s > 0 ? (double) all.samples / elapsed_s : 0.0,
+           percentile_ms(all.latency_ns, all.samples, 0.50), p99, percentile_ms(all.latency_ns, all.samples, 0.999));
+    printf("Errors: %.2f%% ERR responses, %llu timeouts, %d failed connections\n",
+           all.sent ? 100.0 * (double) all.errors / (double) all.sent : 0.0, all.timeouts, *failed);
+
+    for (int t = 0; t < CMD_TYPE_COUNT; t++) free(total[t].latency_ns);
+    free(all.latency_ns);
+    return p99;
+}
+
+/*
+ * Parses "activate=1,deactivate=1,list=4,info=1".
+ */
+static int parse_mix(const char *spec, int *weights) {
+    char copy[128];
+    snprintf(copy, sizeof(copy), "%s", spec);
+    for (int i = 0; i < CMD_TYPE_COUNT; i++) weights[i] = 0;
+
+    int total = 0;
+    char *save;
+    for (char *tok = strtok_r(copy, ",", &save); tok; tok = strtok_r(NULL, ",", &save)) {
+        char *eq = strchr(tok, '=');
+        if (!eq) return -1;
+        *eq = '\0';
+        int found = 0;
+        for (int i = 0; i < CMD_TYPE_COUNT; i++) {
+            if (strcasecmp(tok, command_names[i]) == 0) {
+                weights[i] = atoi(eq + 1);
+                if (weights[i] < 0) return -1;
+                total += weights[i];
+                found = 1;
+            }
+        }
+        if (!found) return -1;
+    }
+    return total > 0 ? 0 : -1;
+}
+
+static int parse_tasks(const char *spec, LoadOptions *opts) {
+    char copy[128];
+    char *save;
+    snprintf(copy, sizeof(copy), "%s", spec);
+    opts->task_count = 0;
+    for (char *tok = strtok_r(copy, ",", &save); tok && opts->task_count < MAX_MIX_TASKS;
+         tok = strtok_r(NULL, ",", &save)) {
+        snprintf(opts->tasks[opts->task_count++], TASK_NAME_LEN, "%s", tok);
+    }
+    return opts->task_count > 0 ? 0 : -1;
+}
+
+static void usage(const char *prog) {
+    printf("Usage: %s [options]\n"
+           "  --host ADDR            Server address (default 127.0.0.1)\n"
+           "  --port N               Server port (default %d)\n"
+           "  --connections N        Concurrent connections (default 4, server limit %d)\n"
+           "  --duration S           Measurement time in seconds (default 10)\n"
+           "  --rate R               Open loop: commands per second over all connections\n"
+           "                         (default: closed loop, one command in flight per connection)\n"
+           "  --mix SPEC             Command weights (default activate=1,deactivate=1,list=4,info=1)\n"
+           "  --tasks LIST           Task names used by ACTIVATE (default t1)\n"
+           "  --timeout-ms N         Response timeout (default 2000)\n"
+           "  --max-p99-ms X         Exit with status 1 if the overall p99 exceeds X\n"
+           "  --transport tcp|shm    Command path (default tcp; shm is closed loop only)\n"
+           "  --shm-channel NAME     Shared-memory channel of the server (default %s)\n",
+           prog, SERVER_PORT, MAX_CLIENTS, SHM_CHANNEL_NAME);
+}
+
+static int parse_args(const int argc, char **argv, LoadOptions *opts) {
+    enum { OPT_HOST = 1, OPT_PORT, OPT_CONNECTIONS, OPT_DURATION, OPT_RATE, OPT_MIX, OPT_TASKS, OPT_TIMEOUT, OPT_MAX_P99,
+        OPT_TRANSPORT, OPT_SHM_CHANNEL
+    };
+    static const struct option options[] = {
+        {"host", required_argument, NULL, OPT_HOST},
+        {"port", required_argument, NULL, OPT_PORT},
+        {"connections", required_argument, NULL, OPT_CONNECTIONS},
+        {"duration", required_argument, NULL, OPT_DURATION},
+        {"rate", required_argument, NULL, OPT_RATE},
+        {"mix", required_argument, NULL, OPT_MIX},
+        {"tasks", required_argument, NULL, OPT_TASKS},
+        {"timeout-ms", required_argument, NULL, OPT_TIMEOUT},
+        {"max-p99-ms", required_argument, NULL, OPT_MAX_P99},
+        {"transport", required_argument, NULL, OPT_TRANSPORT},
+        {"shm-channel", required_argument, NULL, OPT_SHM_CHANNEL},
+        {"help", no_argument, NULL, 'h'},
+        {NULL, 0, NULL, 0}
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "h", options, NULL)) != -1) {
+        switch (opt) {
+            case OPT_HOST: opts->host = optarg;
+                break;
+            case OPT_PORT: opts->port = atoi(optarg);
+                break;
+            case OPT_CONNECTIONS: opts->connections = atoi(optarg);
+                break;
+            case OPT_DURATION: opts->duration_s = atof(optarg);
+                break;
+            case OPT_RATE: opts->rate = atof(optarg);
+                opts->open_loop = 1;
+                break;
+            case OPT_MIX:
+                if (parse_mix(optarg, opts->weights) != 0) {
+                    fprintf(stderr, "Invalid mix '%s'\n", optarg);
+                    return -1;
+                }
+                break;
+            case OPT_TASKS:
+                if (parse_tasks(optarg, opts) != 0) return -1;
+                break;
+            case OPT_TIMEOUT: opts->timeout_ms = atoi(optarg);
+                break;
+            case OPT_MAX_P99: opts->max_p99_ms = atof(optarg);
+                break;
+            case OPT_TRANSPORT:
+                if (strcmp(optarg, "shm") == 0) opts->shm = 1;
+                else if (strcmp(optarg, "tcp") == 0) opts->shm = 0;
+                else {
+                    fprintf(stderr, "Unknown transport '%s'\n", optarg);
+                    return -1;
+                }
+                break;
+            case OPT_SHM_CHANNEL: opts->shm_name = optarg;
+                break;
+            case 'h': usage(argv[0]);
+                exit(EXIT_SUCCESS);
+            default: usage(argv[0]);
+                return -1;
+        }
+    }
+    if (opts->connections < 1 || opts->duration_s <= 0 || opts->timeout_ms < 1 ||
+        (opts->open_loop && opts->rate <= 0) || (opts->open_loop && opts->shm)) {
+        usage(argv[0]);
+        return -1;
+    }
+    return 0;
+}
+
+int main(const int argc, char **argv) {
+    LoadOptions opts = {
+        .host = "127.0.0.1",
+        .port = SERVER_PORT,
+        .connections = 4,
+        .duration_s = 10,
+        .timeout_ms = 2000,
+        .weights = {1, 1, 4, 1},
+        .tasks = {"t1"},
+        .task_count = 1,
+        .shm_name = SHM_CHANNEL_NAME
+    };
+    if (parse_args(argc, argv, &opts) != 0) return EXIT_FAILURE;
+    if (opts.shm && !(shm_channel = shm_client_open(opts.shm_name))) {
+        fprintf(stderr, "No shared-memory channel '%s' (start the server with --shm-channel)\n", opts.shm_name);
+        return EXIT_FAILURE;
+    }
+
+    Worker *workers = calloc((size_t) opts.connections, sizeof(Worker));
+    if (!workers) return EXIT_FAILURE;
+
+    const long long start = now_ns();
+    for (int i = 0; i < opts.connections; i++) {
+        workers[i].index = i;
+        workers[i].opts = &opts;
+        workers[i].seed = (unsigned int) (start ^ (i * 2654435761u));
+        if (pthread_create(&workers[i].thread, NULL, worker_entry, &workers[i]) != 0) {
+            fprintf(stderr, "Failed to start connection %d\n", i);
+            return EXIT_FAILURE;
+        }
+    }
+    long long finished = start;
+    for (int i = 0; i < opts.connections; i++) {
+        pthread_join(workers[i].thread, NULL);
+        if (workers[i].finished_ns > finished) finished = workers[i].finished_ns;
+    }
+    const double elapsed_s = (double) (finished - start) / NSEC_PER_SEC;
+
+    int failed;
+    const double p99 = report(workers, &opts, elapsed_s, &failed);
+
+    int status = EXIT_SUCCESS;
+    if (failed > 0) status = EXIT_FAILURE;
+    if (opts.max_p99_ms > 0 && p99 > opts.max_p99_ms) {
+        printf("FAIL: p99 %.3f ms above the %.3f ms limit\n", p99, opts.max_p99_ms);
+        status = EXIT_FAILURE;
+    }
+
+    for (int i = 0; i < opts.connections; i++) {
+        for (int t = 0; t < CMD_TYPE_COUNT; t++) free(workers[i].stats[t].latency_ns);
+    }
+    free(workers);
+    shm_client_close(shm_channel);
+    return status;
+}
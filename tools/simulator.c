@@ -0,0 +1,503 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include "constants.h"
+#include "admission.h"
+#include "event.h"
+#include "periodic.h"
+#include "task_config.h"
+
+/*
+ * Offline scheduling simulator. Replays a command trace ("<ms> <command>" per
+ * line, as written by --record-commands) against a discrete-event virtual
+ * clock, using the same admission test as the supervisor and the same release
+ * and deadline rules as the runtime threads. Jobs run for their declared WCET
+ * (scaled by --exec-scale) under preemptive fixed priorities on one core.
+ * Mixed criticality follows the runtime: a HI job running past its C_LO
+ * switches to HI mode, which abandons and skips LO jobs until the core idles,
+ * and a LO job running past its C_LO is abandoned.
+ */
+
+#define MSEC_PER_NSEC 1000000LL
+#define DEFAULT_TAIL_MS 10000
+#define SIM_MAX_COMMANDS 65536
+
+typedef struct {
+    long long at_ms;
+    char line[NET_BUFFER_SIZE];
+} SimCommand;
+
+typedef struct {
+    int id;
+    const TaskType *type;
+    long offset_ms;
+    long period_ms;          // Assigned period, read at every advance like inst->period_ms
+    int priority;
+    PeriodicClock clk;
+    long long remaining_ns;  // Execution left of the current job, 0 while sleeping
+    long long executed_ns;   // Execution of the current job so far
+    unsigned long long ready_seq;
+    int stopping;
+    int active;
+    // Statistics
+    long long created_ns;
+    long long stopped_ns;
+    unsigned long long jobs;
+    unsigned long long misses;
+    unsigned long long dropped; // LO jobs abandoned past their C_LO or in HI mode, or skipped in HI mode
+    long long max_response_ns;
+    long long sum_response_ns;
+    long long busy_ns;
+} SimInstance;
+
+typedef struct {
+    long long horizon_ms;
+    double exec_scale;
+    double hi_exec_scale; // Scale of HI jobs, exec_scale unless given
+    int fail_on_miss;
+    int verbose;
+    const char *path;
+} SimOptions;
+
+static SimInstance *instances;
+static int instance_count;
+static int instance_cap;
+static Task active_set[MAX_INSTANCES];
+static int active_count;
+static int next_id = 1;
+static unsigned long long seq;
+static long long now_ns;
+static int hi_mode;
+static unsigned long long mode_switches;
+
+static SimInstance *find_instance(const int id) {
+    for (int i = 0; i < instance_count; i++) {
+        if (instances[i].active && instances[i].id == id) return &instances[i];
+    }
+    return NULL;
+}
+
+static int running_instances(void) {
+    int n = 0;
+    for (int i = 0; i < instance_count; i++) n += instances[i].active;
+    return n;
+}
+
+static void apply_periods(const long *periods_ms) {
+    for (int i = 0; i < active_count; i++) {
+        if (active_set[i].period_ms == periods_ms[i]) continue;
+        printf("[Sim] %10.3f ms ID %d period %ld -> %ld ms\n", (double) now_ns / MSEC_PER_NSEC,
+               active_set[i].instance_id, active_set[i].period_ms, periods_ms[i]);
+        active_set[i].period_ms = periods_ms[i];
+        SimInstance *inst = find_instance(active_set[i].instance_id);
+        if (inst) inst->period_ms = periods_ms[i];
+    }
+}
+
+/*
+ * Applies the deadline-monotonic ranks of the active set, as the supervisor
+ * does after every change to it.
+ */
+static void apply_priorities(const AdmissionPolicy *policy) {
+    int priorities[MAX_INSTANCES];
+    admission_priorities(policy, active_set, active_count, priorities);
+    for (int i = 0; i < active_count; i++) {
+        SimInstance *inst = find_instance(active_set[i].instance_id);
+        if (inst) inst->priority = priorities[i];
+    }
+}
+
+static void sim_activate(const AdmissionPolicy *policy, const Event *ev) {
+    long periods_ms[MAX_ANALYSIS_TASKS];
+    MetricCounter reason;
+    const TaskType *task = tasks_config_get_by_name(&tasks_config, ev->payload.activate.task_name);
+    const long offset_ms = ev->payload.activate.offset_ms;
+
+    if (!task) {
+        printf("[Sim] %10.3f ms ACTIVATE %s -> ERR Unknown Task\n", (double) now_ns / MSEC_PER_NSEC,
+               ev->payload.activate.task_name);
+        return;
+    }
+    const Task candidate = {
+        .type = task, .instance_id = -1, .offset_ms = offset_ms, .wcet_us = admission_wcet_us(policy, task)
+    };
+    if (!admission_check(policy, active_set, active_count, &candidate, periods_ms, &reason)) {
+        printf("[Sim] %10.3f ms ACTIVATE %s -> ERR Schedulability\n", (double) now_ns / MSEC_PER_NSEC, task->name);
+        return;
+    }
+    if (active_count >= MAX_INSTANCES || running_instances() >= MAX_INSTANCES) {
+        printf("[Sim] %10.3f ms ACTIVATE %s -> ERR System Full\n", (double) now_ns / MSEC_PER_NSEC, task->name);
+        return;
+    }
+
+    if (instance_count == instance_cap) {
+        instance_cap = instance_cap ? instance_cap * 2 : 16;
+        instances = realloc(instances, sizeof(SimInstance) * instance_cap);
+        if (!instances) {
+            perror("realloc");
+            exit(EXIT_FAILURE);
+        }
+    }
+    SimInstance *inst = &instances[instance_count++];
+    memset(inst, 0, sizeof(*inst));
+    inst->id = next_id++;
+    inst->type = task;
+    inst->offset_ms = offset_ms;
+    inst->period_ms = periods_ms[active_count];
+    inst->active = 1;
+    inst->created_ns = now_ns;
+    periodic_init(&inst->clk, offset_ms * MSEC_PER_NSEC, task->period_ms * MSEC_PER_NSEC,
+                  inst->period_ms * MSEC_PER_NSEC, now_ns);
+
+    active_set[active_count].type = task;
+    active_set[active_count].instance_id = inst->id;
+    active_set[active_count].offset_ms = offset_ms;
+    active_set[active_count].period_ms = inst->period_ms;
+    active_set[active_count].wcet_us = candidate.wcet_us;
+    active_count++;
+    apply_periods(periods_ms);
+    apply_priorities(policy);
+    printf("[Sim] %10.3f ms ACTIVATE %s %ld -> OK ID=%d\n", (double) now_ns / MSEC_PER_NSEC, task->name, offset_ms,
+           inst->id);
+}
+
+static void sim_deactivate(const AdmissionPolicy *policy, const Event *ev) {
+    long periods_ms[MAX_ANALYSIS_TASKS];
+    MetricCounter reason;
+    const int id = (int) ev->payload.target_id;
+    SimInstance *inst = find_instance(id);
+
+    if (!inst || inst->stopping) {
+        printf("[Sim] %10.3f ms DEACTIVATE %d -> ERR Invalid ID\n", (double) now_ns / MSEC_PER_NSEC, id);
+        return;
+    }
+
+    // Like the runtime thread, a job already released runs to completion before the thread exits
+    inst->stopping = 1;
+    if (inst->remaining_ns == 0) {
+        inst->active = 0;
+        inst->stopped_ns = now_ns;
+    }
+
+    for (int i = 0; i < active_count; i++) {
+        if (active_set[i].instance_id != id) continue;
+        for (int j = i; j < active_count - 1; j++) active_set[j] = active_set[j + 1];
+        active_count--;
+        break;
+    }
+    apply_priorities(policy);
+
+    int compressed = 0;
+    for (int i = 0; i < active_count; i++) {
+        if (active_set[i].period_ms != active_set[i].type->period_ms) compressed = 1;
+    }
+    if (compressed && admission_check(policy, active_set, active_count, NULL, periods_ms, &reason)) {
+        apply_periods(periods_ms);
+    }
+    printf("[Sim] %10.3f ms DEACTIVATE %d -> OK\n", (double) now_ns / MSEC_PER_NSEC, id);
+}
+
+/*
+ * Ends the current job of 'inst' without completing it, like a runtime job
+ * returning from its preemption point.
+ */
+static void abandon_job(SimInstance *inst) {
+    inst->remaining_ns = 0;
+    inst->dropped++;
+    if (inst->stopping) {
+        inst->active = 0;
+        inst->stopped_ns = now_ns;
+        return;
+    }
+    periodic_advance(&inst->clk, inst->period_ms * MSEC_PER_NSEC);
+}
+
+/*
+ * Switch to HI mode: every LO job in progress is abandoned.
+ */
+static void enter_hi_mode(const SimInstance *cause, const SimOptions *opts) {
+    hi_mode = 1;
+    mode_switches++;
+    if (opts->verbose) {
+        printf("[Sim] %10.3f ms HI mode: Task %s (ID %d) exceeded C_LO=%ld ms\n", (double) now_ns / MSEC_PER_NSEC,
+               cause->type->name, cause->id, cause->type->wcet_ms);
+    }
+    for (int i = 0; i < instance_count; i++) {
+        SimInstance *inst = &instances[i];
+        if (inst->active && inst->remaining_ns > 0 && inst->type->criticality == CRIT_LO) abandon_job(inst);
+    }
+}
+
+/*
+ * Marks every instance whose release instant has come as ready.
+ * LO releases are skipped in HI mode.
+ */
+static void release_jobs(const SimOptions *opts) {
+    for (int i = 0; i < instance_count; i++) {
+        SimInstance *inst = &instances[i];
+        if (!inst->active || inst->stopping || inst->remaining_ns > 0) continue;
+        if (inst->clk.release_ns > now_ns) continue;
+        if (hi_mode && inst->type->criticality == CRIT_LO) {
+            inst->dropped++;
+            periodic_advance(&inst->clk, inst->period_ms * MSEC_PER_NSEC);
+            continue;
+        }
+        const double scale = inst->type->criticality == CRIT_HI ? opts->hi_exec_scale : opts->exec_scale;
+        inst->remaining_ns = (long long) ((double) inst->type->wcet_ms * MSEC_PER_NSEC * scale);
+        if (inst->remaining_ns <= 0) inst->remaining_ns = 1;
+        inst->executed_ns = 0;
+        inst->ready_seq = seq++;
+    }
+}
+
+/*
+ * Highest priority ready instance. Equal priorities are served in FIFO order.
+ */
+static SimInstance *pick_running(void) {
+    SimInstance *best = NULL;
+    for (int i = 0; i < instance_count; i++) {
+        SimInstance *inst = &instances[i];
+        if (!inst->active || inst->remaining_ns == 0) continue;
+        if (!best || inst->priority > best->priority ||
+            (inst->priority == best->priority && inst->ready_seq < best->ready_seq)) {
+            best = inst;
+        }
+    }
+    return best;
+}
+
+static void complete_job(SimInstance *inst, const SimOptions *opts) {
+    const long long response_ns = now_ns - inst->clk.release_ns;
+    const long long deadline_ns = periodic_deadline(&inst->clk, inst->type->deadline_ms * MSEC_PER_NSEC);
+
+    inst->jobs++;
+    inst->sum_response_ns += response_ns;
+    if (response_ns > inst->max_response_ns) inst->max_response_ns = response_ns;
+    if (now_ns > deadline_ns) {
+        inst->misses++;
+        if (opts->verbose) {
+            printf("[Sim] %10.3f ms DEADLINE MISS: Task %s (ID %d) | Resp: %.2f ms > Limit: %ld ms\n",
+                   (double) now_ns / MSEC_PER_NSEC, inst->type->name, inst->id,
+                   (double) response_ns / MSEC_PER_NSEC, inst->type->deadline_ms);
+        }
+    }
+
+    if (inst->stopping) {
+        inst->active = 0;
+        inst->stopped_ns = now_ns;
+        return;
+    }
+    // Elastic period change: takes effect from the next release on
+    periodic_advance(&inst->clk, inst->period_ms * MSEC_PER_NSEC);
+}
+
+/*
+ * Advances the virtual clock to 'until_ns', executing ready jobs in priority order.
+ */
+static void run_until(const long long until_ns, const SimOptions *opts) {
+    while (now_ns < until_ns) {
+        release_jobs(opts);
+        SimInstance *running = pick_running();
+
+        // Next instant something changes: a release or the running job's completion
+        long long next_ns = until_ns;
+        for (int i = 0; i < instance_count; i++) {
+            const SimInstance *inst = &instances[i];
+            if (!inst->active || inst->stopping || inst->remaining_ns > 0) continue;
+            if (inst->clk.release_ns > now_ns && inst->clk.release_ns < next_ns) next_ns = inst->clk.release_ns;
+        }
+        if (running && now_ns + running->remaining_ns < next_ns) next_ns = now_ns + running->remaining_ns;
+        // The C_LO budget timer of the running job fires: a HI job switches the mode, a LO job is abandoned
+        long long budget_left_ns = -1;
+        if (running && !hi_mode) {
+            budget_left_ns = running->type->wcet_ms * MSEC_PER_NSEC - running->executed_ns;
+            if (budget_left_ns > 0 && now_ns + budget_left_ns < next_ns) next_ns = now_ns + budget_left_ns;
+        }
+        // Idle instant: back to LO mode
+        if (!running && hi_mode) hi_mode = 0;
+
+        if (running) {
+            running->remaining_ns -= next_ns - now_ns;
+            running->executed_ns += next_ns - now_ns;
+            running->busy_ns += next_ns - now_ns;
+        }
+        const long long step_ns = next_ns - now_ns;
+        now_ns = next_ns;
+        if (running && running->remaining_ns == 0) complete_job(running, opts);
+        else if (running && budget_left_ns >= 0 && step_ns == budget_left_ns) {
+            if (running->type->criticality == CRIT_HI) enter_hi_mode(running, opts);
+            else abandon_job(running);
+        }
+    }
+}
+
+static int load_commands(const char *path, SimCommand **out) {
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        perror("open command trace");
+        return -1;
+    }
+
+    SimCommand *cmds = malloc(sizeof(SimCommand) * SIM_MAX_COMMANDS);
+    char buf[NET_BUFFER_SIZE + 32];
+    int count = 0;
+    long long last_ms = 0;
+    while (fgets(buf, sizeof(buf), f) && count < SIM_MAX_COMMANDS) {
+        long long at_ms;
+        int consumed = 0;
+        buf[strcspn(buf, "\r\n")] = '\0';
+        if (buf[0] == '#' || buf[0] == '\0') continue;
+        if (sscanf(buf, "%lld %n", &at_ms, &consumed) != 1 || at_ms < last_ms) {
+            fprintf(stderr, "%s: malformed or unordered line: %s\n", path, buf);
+            free(cmds);
+            fclose(f);
+            return -1;
+        }
+        last_ms = at_ms;
+        cmds[count].at_ms = at_ms;
+        snprintf(cmds[count].line, sizeof(cmds[count].line), "%s", buf + consumed);
+        count++;
+    }
+    fclose(f);
+    *out = cmds;
+    return count;
+}
+
+static void report(const long long horizon_ns) {
+    unsigned long long jobs = 0, misses = 0;
+    long long busy_ns = 0;
+
+    unsigned long long dropped = 0;
+
+    printf("\n%-4s %-6s %6s %6s %6s %8s %8s %8s %10s %10s %7s\n",
+           "ID", "Task", "O", "T", "D", "Jobs", "Misses", "Dropped", "MaxR(ms)", "AvgR(ms)", "Util");
+    for (int i = 0; i < instance_count; i++) {
+        const SimInstance *inst = &instances[i];
+        const long long end_ns = inst->active ? horizon_ns : inst->stopped_ns;
+        const long long life_ns = end_ns - inst->created_ns;
+        printf("%-4d %-6s %6ld %6ld %6ld %8llu %8llu %8llu %10.3f %10.3f %6.1f%%\n",
+               inst->id, inst->type->name, inst->offset_ms, inst->period_ms, inst->type->deadline_ms,
+               inst->jobs, inst->misses, inst->dropped, (double) inst->max_response_ns / MSEC_PER_NSEC,
+               inst->jobs ? (double) inst->sum_response_ns / (double) inst->jobs / MSEC_PER_NSEC : 0.0,
+               life_ns > 0 ? 100.0 * (double) inst->busy_ns / (double) life_ns : 0.0);
+        jobs += inst->jobs;
+        misses += inst->misses;
+        dropped += inst->dropped;
+        busy_ns += inst->busy_ns;
+    }
+    printf("\nSimulated %.3f s: %llu jobs, %llu deadline misses, CPU utilization %.1f%%\n",
+           (double) horizon_ns / 1e9, jobs, misses, horizon_ns > 0 ? 100.0 * (double) busy_ns / (double) horizon_ns : 0.0);
+    printf("Criticality: %llu switches to HI mode, %llu LO jobs dropped\n", mode_switches, dropped);
+}
+
+static void print_usage(const char *prog) {
+    printf("Usage: %s [options] <command-trace>\n"
+           "  --horizon MS       Simulated time (default: last command + %d ms)\n"
+           "  --exec-scale X     Job execution time as a multiple of the declared WCET (default 1.0)\n"
+           "  --hi-exec-scale X  Same for HI tasks, as a multiple of C_LO (default: --exec-scale)\n"
+           "  --fail-on-miss     Exit with status 1 if any deadline is missed\n"
+           "  --verbose          Log every deadline miss\n"
+           "  --help             Show this message\n", prog, DEFAULT_TAIL_MS);
+}
+
+enum {
+    OPT_HORIZON = 1,
+    OPT_EXEC_SCALE,
+    OPT_HI_EXEC_SCALE,
+    OPT_FAIL_ON_MISS,
+    OPT_VERBOSE,
+    OPT_HELP
+};
+
+static int parse_args(const int argc, char **argv, SimOptions *opts) {
+    static const struct option long_opts[] = {
+        {"horizon", required_argument, NULL, OPT_HORIZON},
+        {"exec-scale", required_argument, NULL, OPT_EXEC_SCALE},
+        {"hi-exec-scale", required_argument, NULL, OPT_HI_EXEC_SCALE},
+        {"fail-on-miss", no_argument, NULL, OPT_FAIL_ON_MISS},
+        {"verbose", no_argument, NULL, OPT_VERBOSE},
+        {"help", no_argument, NULL, OPT_HELP},
+        {NULL, 0, NULL, 0}
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "", long_opts, NULL)) != -1) {
+        switch (opt) {
+            case OPT_HORIZON: opts->horizon_ms = atoll(optarg);
+                if (opts->horizon_ms <= 0) {
+                    fprintf(stderr, "Invalid horizon: %s\n", optarg);
+                    return -1;
+                }
+                break;
+            case OPT_EXEC_SCALE: opts->exec_scale = atof(optarg);
+                if (opts->exec_scale <= 0) {
+                    fprintf(stderr, "Invalid execution scale: %s\n", optarg);
+                    return -1;
+                }
+                break;
+            case OPT_HI_EXEC_SCALE: opts->hi_exec_scale = atof(optarg);
+                if (opts->hi_exec_scale <= 0) {
+                    fprintf(stderr, "Invalid execution scale: %s\n", optarg);
+                    return -1;
+                }
+                break;
+            case OPT_FAIL_ON_MISS: opts->fail_on_miss = 1;
+                break;
+            case OPT_VERBOSE: opts->verbose = 1;
+                break;
+            case OPT_HELP: print_usage(argv[0]);
+                exit(EXIT_SUCCESS);
+            default: print_usage(argv[0]);
+                return -1;
+        }
+    }
+    if (opts->hi_exec_scale <= 0) opts->hi_exec_scale = opts->exec_scale;
+    if (optind >= argc) {
+        print_usage(argv[0]);
+        return -1;
+    }
+    opts->path = argv[optind];
+    return 0;
+}
+
+int main(const int argc, char **argv) {
+    SimOptions opts = {.horizon_ms = -1, .exec_scale = 1.0};
+    const AdmissionPolicy policy = {.mode = ADMISSION_DECLARED, .wcet_margin = PROFILE_DEFAULT_MARGIN};
+    SimCommand *cmds;
+
+    if (parse_args(argc, argv, &opts) != 0) return EXIT_FAILURE;
+    const int count = load_commands(opts.path, &cmds);
+    if (count < 0) return EXIT_FAILURE;
+
+    long long horizon_ns = opts.horizon_ms > 0
+                               ? opts.horizon_ms * MSEC_PER_NSEC
+                               : ((count ? cmds[count - 1].at_ms : 0) + DEFAULT_TAIL_MS) * MSEC_PER_NSEC;
+
+    for (int i = 0; i < count; i++) {
+        const long long at_ns = cmds[i].at_ms * MSEC_PER_NSEC;
+        if (at_ns > horizon_ns) break;
+        run_until(at_ns, &opts);
+
+        Event ev;
+        if (event_parse(cmds[i].line, -1, &ev) != 0) {
+            printf("[Sim] %10.3f ms %s -> ERR Invalid Command\n", (double) now_ns / MSEC_PER_NSEC, cmds[i].line);
+            continue;
+        }
+        if (ev.type == EV_ACTIVATE) sim_activate(&policy, &ev);
+        else if (ev.type == EV_DEACTIVATE) sim_deactivate(&policy, &ev);
+        else if (ev.type == EV_SHUTDOWN) {
+            horizon_ns = now_ns;
+            break;
+        }
+        // LIST, INFO, METRICS and TRACE do not affect the schedule
+    }
+    run_until(horizon_ns, &opts);
+    report(horizon_ns);
+
+    unsigned long long misses = 0;
+    for (int i = 0; i < instance_count; i++) misses += instances[i].misses;
+    free(cmds);
+    free(instances);
+    return (opts.fail_on_miss && misses > 0) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,158 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include "trace.h"
+
+/*
+ * Offline converter from the binary trace written by TRACE DUMP
+ * to the Chrome trace event JSON format (chrome://tracing, ui.perfetto.dev).
+ * Every instance becomes one thread row, the supervisor is thread 0.
+ */
+
+typedef struct {
+    int32_t id;
+    uint64_t start_ns;
+} OpenJob;
+
+static int compare_ts(const void *a, const void *b) {
+    const TraceRecord *ra = a;
+    const TraceRecord *rb = b;
+    if (ra->ts_ns != rb->ts_ns) return (ra->ts_ns > rb->ts_ns) ? 1 : -1;
+    return 0;
+}
+
+static const char *task_name(const TraceFileHeader *h, const uint16_t task) {
+    return task < h->task_count ? h->task_names[task] : "?";
+}
+
+static double rel_us(const uint64_t ts, const uint64_t t0) {
+    return (double) (ts - t0) / 1000.0;
+}
+
+static OpenJob *find_job(OpenJob *jobs, const int count, const int32_t id) {
+    for (int i = 0; i < count; i++) {
+        if (jobs[i].id == id) return &jobs[i];
+    }
+    return NULL;
+}
+
+int main(const int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <trace.bin> [out.json]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    FILE *in = fopen(argv[1], "rb");
+    if (!in) {
+        perror("open trace");
+        return EXIT_FAILURE;
+    }
+
+    TraceFileHeader h;
+    if (fread(&h, sizeof(h), 1, in) != 1 || memcmp(h.magic, TRACE_MAGIC, sizeof(h.magic)) != 0 ||
+        h.version != TRACE_VERSION) {
+        fprintf(stderr, "%s: not a version %d trace file\n", argv[1], TRACE_VERSION);
+        fclose(in);
+        return EXIT_FAILURE;
+    }
+    if (h.task_count > N_TASKS) h.task_count = N_TASKS;
+
+    // The count comes from the file: it must match the records that follow the header
+    struct stat st;
+    if (fstat(fileno(in), &st) != 0 || st.st_size < (off_t) sizeof(h) ||
+        h.record_count > (uint64_t) (st.st_size - (off_t) sizeof(h)) / sizeof(TraceRecord)) {
+        fprintf(stderr, "%s: header announces %llu records, more than the file holds\n", argv[1],
+                (unsigned long long) h.record_count);
+        fclose(in);
+        return EXIT_FAILURE;
+    }
+    TraceRecord *recs = malloc((h.record_count ? h.record_count : 1) * sizeof(TraceRecord));
+    if (!recs) {
+        perror("malloc");
+        fclose(in);
+        return EXIT_FAILURE;
+    }
+    const size_t n = fread(recs, sizeof(TraceRecord), h.record_count, in);
+    fclose(in);
+    qsort(recs, n, sizeof(TraceRecord), compare_ts);
+
+    FILE *out = argc > 2 ? fopen(argv[2], "w") : stdout;
+    if (!out) {
+        perror("open output");
+        free(recs);
+        return EXIT_FAILURE;
+    }
+
+    const uint64_t t0 = n ? recs[0].ts_ns : 0;
+    OpenJob *jobs = calloc(n ? n : 1, sizeof(OpenJob));
+    int job_count = 0;
+    if (!jobs) {
+        perror("calloc");
+        if (out != stdout) fclose(out);
+        free(recs);
+        return EXIT_FAILURE;
+    }
+
+    fprintf(out, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    fprintf(out, "{\"ph\":\"M\",\"pid\":1,\"name\":\"process_name\",\"args\":{\"name\":\"dynamic_periodic_task\"}},\n");
+    fprintf(out, "{\"ph\":\"M\",\"pid\":1,\"tid\":0,\"name\":\"thread_name\",\"args\":{\"name\":\"supervisor\"}}");
+
+    for (size_t i = 0; i < n; i++) {
+        const TraceRecord *r = &recs[i];
+        const char *name = task_name(&h, r->task);
+        const double ts = rel_us(r->ts_ns, t0);
+
+        switch (r->type) {
+            case TRACE_RELEASE:
+                if (!find_job(jobs, job_count, r->instance_id)) {
+                    jobs[job_count].id = r->instance_id;
+                    jobs[job_count].start_ns = 0;
+                    job_count++;
+                    fprintf(out, ",\n{\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"name\":\"thread_name\","
+                            "\"args\":{\"name\":\"%s #%d\"}}", r->instance_id, name, r->instance_id);
+                }
+                fprintf(out, ",\n{\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"name\":\"release\"}",
+                        r->instance_id, ts);
+                break;
+            case TRACE_START: {
+                OpenJob *job = find_job(jobs, job_count, r->instance_id);
+                if (job) job->start_ns = r->ts_ns;
+                break;
+            }
+            case TRACE_END: {
+                const OpenJob *job = find_job(jobs, job_count, r->instance_id);
+                if (!job || job->start_ns == 0) break;
+                fprintf(out, ",\n{\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,\"name\":\"%s\"}",
+                        r->instance_id, rel_us(job->start_ns, t0), (double) (r->ts_ns - job->start_ns) / 1000.0,
+                        name);
+                break;
+            }
+            case TRACE_SLEEP:
+                fprintf(out, ",\n{\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"name\":\"sleep\","
+                        "\"args\":{\"next_release_us\":%.3f}}", r->instance_id, ts, rel_us((uint64_t) r->arg, t0));
+                break;
+            case TRACE_MISS:
+                fprintf(out, ",\n{\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"name\":\"deadline miss\","
+                        "\"args\":{\"response_ms\":%.3f}}", r->instance_id, ts, (double) r->arg / 1e6);
+                break;
+            case TRACE_ADMIT:
+            case TRACE_REJECT:
+            case TRACE_DEACTIVATE: {
+                const char *what = r->type == TRACE_ADMIT ? "admit" : r->type == TRACE_REJECT ? "reject" : "deactivate";
+                fprintf(out, ",\n{\"ph\":\"i\",\"s\":\"p\",\"pid\":1,\"tid\":0,\"ts\":%.3f,\"name\":\"%s %s\","
+                        "\"args\":{\"id\":%d}}", ts, what, name, r->instance_id);
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    fprintf(out, "\n]}\n");
+    if (out != stdout) fclose(out);
+    free(jobs);
+    free(recs);
+    fprintf(stderr, "Converted %zu records\n", n);
+    return EXIT_SUCCESS;
+}